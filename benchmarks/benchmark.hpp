@@ -0,0 +1,94 @@
+#pragma once
+
+#include <chrono>
+#include <cstdio>
+
+/* Shared harness for the module benchmarks.
+   Each benchmark is a single translation unit that includes a module's source, builds the module without an engine,
+   patches its ports by hand and times process(). Results are nanoseconds per frame: lower is better. */
+
+// The modules only read this from their widgets, which the benchmarks never build.
+Plugin* pluginInstance = nullptr;
+
+namespace benchmarks {
+    static const float kSampleRate = 48000.f;
+    static const int kWarmupFrames = 1 << 12;
+    static const int kFrames = 1 << 18;
+
+    inline void sendPortChange(Module& module, const Port::Type type, const int portId, const bool bConnecting) {
+        Module::PortChangeEvent e;
+        e.connecting = bConnecting;
+        e.type = type;
+        e.portId = portId;
+        module.onPortChange(e);
+    }
+
+    // Voltages differ between channels, so polyphonic lanes don't all take the same path.
+    inline void connectInput(Module& module, const int inputId, const int channels = 1, const float voltage = 1.f) {
+        Input& input = module.inputs[inputId];
+        input.setChannels(channels);
+        for (int channel = 0; channel < channels; ++channel) {
+            input.setVoltage(voltage + channel * 0.25f, channel);
+        }
+        sendPortChange(module, Port::INPUT, inputId, true);
+    }
+
+    // An output counts as patched once it has channels, as it does when the engine connects a cable.
+    inline void connectOutput(Module& module, const int outputId) {
+        module.outputs[outputId].setChannels(1);
+        sendPortChange(module, Port::OUTPUT, outputId, true);
+    }
+
+    // A port whose connection sets one bit of a kernel mask.
+    struct MaskedPort {
+        int bit;
+        Port::Type type;
+        int portId;
+    };
+
+    // Patches the ports of the bits set in the mask; inputs get the given channels.
+    inline void connectMask(Module& module, const MaskedPort* ports, const int portCount, const int mask,
+        const int channels = 1) {
+        for (int port = 0; port < portCount; ++port) {
+            if (mask & ports[port].bit) {
+                if (ports[port].type == Port::INPUT) {
+                    connectInput(module, ports[port].portId, channels);
+                } else {
+                    connectOutput(module, ports[port].portId);
+                }
+            }
+        }
+    }
+
+    inline void prepare(Module& module) {
+        Module::SampleRateChangeEvent e;
+        e.sampleRate = kSampleRate;
+        e.sampleTime = 1.f / kSampleRate;
+        module.onSampleRateChange(e);
+    }
+
+    // Returns the mean time per frame in nanoseconds.
+    inline double run(Module& module, const int frames = kFrames) {
+        Module::ProcessArgs args;
+        args.sampleRate = kSampleRate;
+        args.sampleTime = 1.f / kSampleRate;
+
+        for (int frame = 0; frame < kWarmupFrames; ++frame) {
+            args.frame = frame;
+            module.process(args);
+        }
+
+        const auto start = std::chrono::steady_clock::now();
+        for (int frame = 0; frame < frames; ++frame) {
+            args.frame = kWarmupFrames + frame;
+            module.process(args);
+        }
+        const auto end = std::chrono::steady_clock::now();
+
+        return std::chrono::duration<double, std::nano>(end - start).count() / frames;
+    }
+
+    inline void report(const char* name, const double nanoseconds) {
+        std::printf("%-60s %9.1f ns/frame\n", name, nanoseconds);
+    }
+}
@@ -0,0 +1,44 @@
+#include "../src/bukavac.cpp"
+
+#include "benchmark.hpp"
+
+// Times every white, pink and Perlin kernel with only that family's ports patched.
+
+static const benchmarks::MaskedPort kWhitePorts[] = {
+	{ Bukavac::CONNECTION_WHITE, Port::OUTPUT, Bukavac::OUTPUT_WHITE },
+	{ Bukavac::CONNECTION_RED, Port::OUTPUT, Bukavac::OUTPUT_RED },
+	{ Bukavac::CONNECTION_VIOLET, Port::OUTPUT, Bukavac::OUTPUT_VIOLET },
+	{ Bukavac::CONNECTION_GRAY, Port::OUTPUT, Bukavac::OUTPUT_GRAY }
+};
+
+static const benchmarks::MaskedPort kPinkPorts[] = {
+	{ Bukavac::CONNECTION_PINK, Port::OUTPUT, Bukavac::OUTPUT_PINK },
+	{ Bukavac::CONNECTION_BLUE, Port::OUTPUT, Bukavac::OUTPUT_BLUE }
+};
+
+static const benchmarks::MaskedPort kPerlinPorts[] = {
+	{ Bukavac::CONNECTION_PERLIN_MIX, Port::OUTPUT, Bukavac::OUTPUT_PERLIN_NOISE_MIX },
+	{ Bukavac::CONNECTION_PERLIN_SPEED, Port::INPUT, Bukavac::INPUT_PERLIN_SPEED },
+	{ Bukavac::CONNECTION_PERLIN_AMP, Port::INPUT, Bukavac::INPUT_PERLIN_AMP }
+};
+
+static void benchmarkFamily(const char* family, const benchmarks::MaskedPort* ports, const int portCount,
+	const int kernelCount, const bool bIsPerlin) {
+	for (int mask = 0; mask < kernelCount; ++mask) {
+		Bukavac module;
+		benchmarks::prepare(module);
+		benchmarks::connectMask(module, ports, portCount, mask);
+		// Without the mix, an octave output keeps the Perlin kernel running.
+		if (bIsPerlin && !(mask & Bukavac::CONNECTION_PERLIN_MIX)) {
+			benchmarks::connectOutput(module, Bukavac::OUTPUT_PERLIN_NOISE0);
+		}
+		benchmarks::report(string::f("Bukavac %s kernel 0x%x", family, mask).c_str(), benchmarks::run(module));
+	}
+}
+
+int main() {
+	benchmarkFamily("white", kWhitePorts, 4, Bukavac::WHITE_CONNECTIONS_COUNT, false);
+	benchmarkFamily("pink", kPinkPorts, 2, Bukavac::PINK_CONNECTIONS_COUNT, false);
+	benchmarkFamily("Perlin", kPerlinPorts, 3, Bukavac::PERLIN_CONNECTIONS_COUNT, true);
+	return 0;
+}
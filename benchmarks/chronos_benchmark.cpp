@@ -0,0 +1,97 @@
+#include "../src/chronos.cpp"
+
+#include "benchmark.hpp"
+
+/* Times every section kernel, the same on all four sections, at audio and CV rate, with mono and 16 channel FM.
+   Mono sections at audio rate take the packed path instead of the kernels.
+   Ends with the mean over every kernel at each rate, to show what CV rate saves, and with CV rate set before the
+   ports are patched, which must not send the sections back to audio rate. */
+
+static void patchSections(Chronos& module, const int mask, const int channels) {
+	for (int section = 0; section < chronos::kMaxSections; ++section) {
+		benchmarks::connectInput(module, Chronos::INPUT_FM_1 + section, channels);
+		if (mask & Chronos::CONNECTION_SINE) {
+			benchmarks::connectOutput(module, Chronos::OUTPUT_SINE_1 + section);
+		}
+		if (mask & Chronos::CONNECTION_TRIANGLE) {
+			benchmarks::connectOutput(module, Chronos::OUTPUT_TRIANGLE_1 + section);
+		}
+		if (mask & Chronos::CONNECTION_SAW) {
+			benchmarks::connectOutput(module, Chronos::OUTPUT_SAW_1 + section);
+		}
+		if (mask & Chronos::CONNECTION_SQUARE) {
+			benchmarks::connectOutput(module, Chronos::OUTPUT_SQUARE_1 + section);
+		}
+	}
+}
+
+// Applied on the next processed frame, as it is from the menu.
+static void requestCvRates(Chronos& module, const bool bCvRate) {
+	for (int section = 0; section < chronos::kMaxSections; ++section) {
+		module.requestCvRate(section, bCvRate);
+	}
+}
+
+static double benchmarkMask(const int mask, const bool bCvRate, const int channels) {
+	Chronos module;
+	benchmarks::prepare(module);
+
+	patchSections(module, mask, channels);
+	requestCvRates(module, bCvRate);
+
+	return benchmarks::run(module);
+}
+
+// Sets CV rate and processes a frame before patching, so the port changes come after the rate change.
+static double benchmarkPatchedAfterCvRate(const int channels, bool& bStillCvRate) {
+	Chronos module;
+	benchmarks::prepare(module);
+
+	requestCvRates(module, true);
+	benchmarks::run(module, 1);
+
+	patchSections(module, Chronos::CONNECTIONS_COUNT - 1, channels);
+
+	const double nanoseconds = benchmarks::run(module);
+	bStillCvRate = module.bHaveCvRateSections;
+	return nanoseconds;
+}
+
+int main() {
+	static const int kChannelCounts[] = { 1, PORT_MAX_CHANNELS };
+
+	double rateMeans[2][2] = {};
+
+	for (int channelIndex = 0; channelIndex < 2; ++channelIndex) {
+		const int channels = kChannelCounts[channelIndex];
+		for (int rate = 0; rate < 2; ++rate) {
+			const bool bCvRate = rate == 1;
+			for (int mask = 0; mask < Chronos::CONNECTIONS_COUNT; ++mask) {
+				const bool bIsPacked = channels == 1 && !bCvRate;
+				const double nanoseconds = benchmarkMask(mask, bCvRate, channels);
+				benchmarks::report(string::f("Chronos %s 0x%x, %s rate, %d channels", bIsPacked ? "packed" : "kernel",
+					mask, bCvRate ? "CV" : "audio", channels).c_str(), nanoseconds);
+				rateMeans[channelIndex][rate] += nanoseconds / Chronos::CONNECTIONS_COUNT;
+			}
+		}
+	}
+
+	for (int channelIndex = 0; channelIndex < 2; ++channelIndex) {
+		for (int rate = 0; rate < 2; ++rate) {
+			benchmarks::report(string::f("Chronos mean, %s rate, %d channels", rate == 1 ? "CV" : "audio",
+				kChannelCounts[channelIndex]).c_str(), rateMeans[channelIndex][rate]);
+		}
+	}
+
+	bool bPassed = true;
+	for (const int channels : kChannelCounts) {
+		bool bStillCvRate = false;
+		benchmarks::report(string::f("Chronos CV rate set before patching, %d channels", channels).c_str(),
+			benchmarkPatchedAfterCvRate(channels, bStillCvRate));
+		if (!bStillCvRate) {
+			std::printf("Chronos sections left CV rate when their ports were patched, %d channels\n", channels);
+			bPassed = false;
+		}
+	}
+	return bPassed ? 0 : 1;
+}
@@ -0,0 +1,59 @@
+#include "../src/kitsune.cpp"
+
+#include "benchmark.hpp"
+
+/* Times both kernels, with and without Denki, on one patched section with mono and 16 channel inputs, then all four
+   sections with every input patched and with only the first input normalled to every output. */
+
+static double benchmarkKernel(const bool bWithExpander, const int channels) {
+	Kitsune module;
+	Denki expander;
+	benchmarks::prepare(module);
+	benchmarks::prepare(expander);
+
+	if (bWithExpander) {
+		// Attached by hand: there's no engine to send the expander change.
+		module.rightExpander.module = &expander;
+		expander.leftExpander.module = &module;
+		module.bHaveExpander = true;
+		module.updateProcessKernel();
+		benchmarks::connectInput(expander, Denki::INPUT_GAIN_CV, channels);
+		benchmarks::connectInput(expander, Denki::INPUT_OFFSET_CV, channels);
+	}
+
+	benchmarks::connectInput(module, Kitsune::INPUT_VOLTAGE1, channels);
+	benchmarks::connectOutput(module, Kitsune::OUTPUT_VOLTAGE1);
+
+	return benchmarks::run(module);
+}
+
+static double benchmarkSections(const int inputCount, const int channels) {
+	Kitsune module;
+	benchmarks::prepare(module);
+
+	for (int section = 0; section < kitsune::kMaxSections; ++section) {
+		if (section < inputCount) {
+			benchmarks::connectInput(module, Kitsune::INPUT_VOLTAGE1 + section, channels);
+		}
+		benchmarks::connectOutput(module, Kitsune::OUTPUT_VOLTAGE1 + section);
+	}
+
+	return benchmarks::run(module);
+}
+
+int main() {
+	static const int kChannelCounts[] = { 1, PORT_MAX_CHANNELS };
+
+	for (const int channels : kChannelCounts) {
+		for (int mask = 0; mask < Kitsune::CONNECTIONS_COUNT; ++mask) {
+			benchmarks::report(string::f("Kitsune kernel 0x%x, %d channels", mask, channels).c_str(),
+				benchmarkKernel(mask & Kitsune::CONNECTION_EXPANDER, channels));
+		}
+
+		benchmarks::report(string::f("Kitsune all sections patched, %d channels", channels).c_str(),
+			benchmarkSections(kitsune::kMaxSections, channels));
+		benchmarks::report(string::f("Kitsune all sections normalled to input 1, %d channels", channels).c_str(),
+			benchmarkSections(1, channels));
+	}
+	return 0;
+}
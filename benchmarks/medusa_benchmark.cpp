@@ -0,0 +1,32 @@
+#include "../src/medusa.cpp"
+
+#include "benchmark.hpp"
+
+/* Times Medusa with all 32 outputs patched, fed by every input and by the first input normalled to all of them, with
+   mono and 16 channel inputs. */
+
+static double benchmarkPorts(const int inputCount, const int channels) {
+	Medusa module;
+	benchmarks::prepare(module);
+
+	for (int port = 0; port < medusa::kMaxPorts; ++port) {
+		if (port < inputCount) {
+			benchmarks::connectInput(module, Medusa::INPUT_VOLTAGE + port, channels);
+		}
+		benchmarks::connectOutput(module, Medusa::OUTPUT_VOLTAGE + port);
+	}
+
+	return benchmarks::run(module);
+}
+
+int main() {
+	static const int kChannelCounts[] = { 1, PORT_MAX_CHANNELS };
+
+	for (const int channels : kChannelCounts) {
+		benchmarks::report(string::f("Medusa all ports patched, %d channels", channels).c_str(),
+			benchmarkPorts(medusa::kMaxPorts, channels));
+		benchmarks::report(string::f("Medusa all ports normalled to input 1, %d channels", channels).c_str(),
+			benchmarkPorts(1, channels));
+	}
+	return 0;
+}
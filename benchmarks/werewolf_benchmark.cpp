@@ -0,0 +1,27 @@
+#include "../src/werewolf.cpp"
+
+#include "benchmark.hpp"
+
+// Times every kernel with mono and 16 channel inputs.
+
+static const benchmarks::MaskedPort kPorts[] = {
+	{ Werewolf::CONNECTION_LEFT_IN, Port::INPUT, Werewolf::INPUT_LEFT },
+	{ Werewolf::CONNECTION_RIGHT_IN, Port::INPUT, Werewolf::INPUT_RIGHT },
+	{ Werewolf::CONNECTION_LEFT_OUT, Port::OUTPUT, Werewolf::OUTPUT_LEFT },
+	{ Werewolf::CONNECTION_RIGHT_OUT, Port::OUTPUT, Werewolf::OUTPUT_RIGHT }
+};
+
+int main() {
+	static const int kChannelCounts[] = { 1, PORT_MAX_CHANNELS };
+
+	for (const int channels : kChannelCounts) {
+		for (int mask = 0; mask < Werewolf::CONNECTIONS_COUNT; ++mask) {
+			Werewolf module;
+			benchmarks::prepare(module);
+			benchmarks::connectMask(module, kPorts, 4, mask, channels);
+			benchmarks::report(string::f("Werewolf kernel 0x%x, %d channels", mask, channels).c_str(),
+				benchmarks::run(module));
+		}
+	}
+	return 0;
+}
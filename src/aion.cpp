@@ -6,6 +6,13 @@
 #include "seqcomponents.hpp"
 #endif
 
+#include "displaysnapshot.hpp"
+#include "triggerbank.hpp"
+
+#include "aion.hpp"
+
+#include <atomic>
+
 using namespace sanguineCommonCode;
 
 struct Aion : SanguineModule {
@@ -46,6 +53,10 @@ struct Aion : SanguineModule {
 		INPUT_RUN_2,
 		INPUT_RUN_3,
 		INPUT_RUN_4,
+		INPUT_DURATION_1,
+		INPUT_DURATION_2,
+		INPUT_DURATION_3,
+		INPUT_DURATION_4,
 		INPUTS_COUNT
 	};
 
@@ -73,29 +84,56 @@ struct Aion : SanguineModule {
 
 	static const int kKnobsFrequency = 64;
 	static const int kModuleSections = 4;
+	static const int kChannelGroups = PORT_MAX_CHANNELS / 4;
 
 	bool timersStarted[kModuleSections] = {};
 
-	bool lastTimerEdges[kModuleSections] = {};
 	bool inputTriggers[kModuleSections] = {};
 	bool outputTriggers[kModuleSections] = {};
 
 	int setTimerValues[kModuleSections] = {};
 	int currentTimerValues[kModuleSections] = {};
 
-	float currentTime = 0.f;
+	aion::TimeBases timeBase = aion::TIME_BASE_SECONDS;
+
+	// Internal ticks are counted in whole samples, so timers don't drift and render the same at any sample rate.
+	int tickSamples = 44100;
+	int elapsedSamples[kModuleSections] = {};
+	/* Set from the UI thread, applied in process() so ticks aren't counted against a changing length and outputs
+	   don't change channels while they're written. */
+	aion::TimeBases pendingTimeBase = aion::TIME_BASE_SECONDS;
+	bool bPendingPolyphonic = false;
+	std::atomic<bool> bHavePendingSettings{ false };
+
+	// Matches the default dsp::PulseGenerator trigger.
+	static constexpr float kEndPulseDuration = 1e-3f;
+	float endPulseSamples = 44.f;
+
+	// Polyphonic mode: every section runs one timer per channel of its inputs.
+	bool bPolyphonic = false;
+	aion::TimerBank4 polyTimers[kModuleSections][kChannelGroups];
+	triggerBanks::SchmittTriggerBank<> stPolyResetInputs[kModuleSections];
+	triggerBanks::SchmittTriggerBank<> stPolyRunInputs[kModuleSections];
+	triggerBanks::SchmittTriggerBank<> stPolyTriggerInputs[kModuleSections];
 
 	dsp::ClockDivider knobsDivider;
 
 	dsp::BooleanTrigger btResetButtons[kModuleSections];
 	dsp::BooleanTrigger btRunButtons[kModuleSections];
 	dsp::BooleanTrigger btTriggerButtons[kModuleSections];
-	dsp::SchmittTrigger stResetInputs[kModuleSections];
-	dsp::SchmittTrigger stRunInputs[kModuleSections];
-	dsp::SchmittTrigger stTriggerInputs[kModuleSections];
+	// One lane per section.
+	triggerBanks::SchmittTriggerBank<kModuleSections> stResetInputs;
+	triggerBanks::SchmittTriggerBank<kModuleSections> stRunInputs;
+	triggerBanks::SchmittTriggerBank<kModuleSections> stTriggerInputs;
 	dsp::PulseGenerator pgTimerLights[kModuleSections];
 	dsp::PulseGenerator pgTriggerOutputs[kModuleSections];
 
+	struct DisplaySnapshot {
+		int timerValues[kModuleSections];
+	};
+
+	displaySnapshots::TripleBuffer<DisplaySnapshot> displayBuffer;
+
 	Aion() {
 		config(PARAMS_COUNT, INPUTS_COUNT, OUTPUTS_COUNT, LIGHTS_COUNT);
 
@@ -113,6 +151,7 @@ struct Aion : SanguineModule {
 			configInput(INPUT_TRIGGER_1 + section, string::f("Advance timer %d", currentNumber));
 			configInput(INPUT_RESET_1 + section, string::f("Reset timer %d", currentNumber));
 			configInput(INPUT_RUN_1 + section, string::f("Start/stop timer %d", currentNumber));
+			configInput(INPUT_DURATION_1 + section, string::f("Timer %d duration CV (polyphonic timers only)", currentNumber));
 
 			configOutput(OUTPUT_TRIGGER_1 + section, string::f("Timer end %d", currentNumber));
 
@@ -121,60 +160,77 @@ struct Aion : SanguineModule {
 
 			knobsDivider.setDivision(kKnobsFrequency);
 		}
+
+		publishDisplaySnapshot();
 	}
 
 	void process(const ProcessArgs& args) override {
+		if (bHavePendingSettings.exchange(false, std::memory_order_acquire)) {
+			setTimeBase(pendingTimeBase, args.sampleRate);
+			setPolyphonic(bPendingPolyphonic);
+		}
 
 		bool bIsControlsTurn = knobsDivider.process();
 
-		bool bInternalTimerSecond = false;
-		currentTime += args.sampleTime;
-		if (currentTime > 1.f) {
-			currentTime -= 1.f;
-			bInternalTimerSecond = true;
-		} else if (currentTime < 0.5f) {
-			bInternalTimerSecond = true;
+		if (!bPolyphonic) {
+			processMonophonic(args, bIsControlsTurn);
+		} else {
+			processPolyphonic(args, bIsControlsTurn);
 		}
 
+		if (bIsControlsTurn) {
+			publishDisplaySnapshot();
+		}
+	}
+
+	void processMonophonic(const ProcessArgs& args, const bool bIsControlsTurn) {
+		simd::float_4 resetVoltages;
+		simd::float_4 runVoltages;
+		simd::float_4 triggerVoltages;
 		for (int section = 0; section < kModuleSections; ++section) {
-			if (bInternalTimerSecond) {
-				if (!inputTriggers[section]) {
-					if (lastTimerEdges[section] != bInternalTimerSecond) {
-						if (timersStarted[section]) {
-							decreaseTimer(section);
-						}
-						lastTimerEdges[section] = bInternalTimerSecond;
-					}
+			resetVoltages[section] = inputs[INPUT_RESET_1 + section].getVoltage();
+			runVoltages[section] = inputs[INPUT_RUN_1 + section].getVoltage();
+			triggerVoltages[section] = inputs[INPUT_TRIGGER_1 + section].getVoltage();
+		}
+		int triggeredResets = stResetInputs.processBits(0, resetVoltages);
+		int triggeredRuns = stRunInputs.processBits(0, runVoltages);
+		int triggeredTriggers = stTriggerInputs.processBits(0, triggerVoltages);
 
-					lights[LIGHT_TIMER_1 + section].setBrightnessSmooth(timersStarted[section], args.sampleTime);
-				}
-			} else {
-				if (!inputTriggers[section]) {
-					lights[LIGHT_TIMER_1 + section].setBrightnessSmooth(0.f, args.sampleTime);
+		for (int section = 0; section < kModuleSections; ++section) {
+			if (!inputTriggers[section]) {
+				if (timersStarted[section]) {
+					++elapsedSamples[section];
+					if (elapsedSamples[section] >= tickSamples) {
+						elapsedSamples[section] = 0;
+						decreaseTimer(section);
+					}
 				}
-				lastTimerEdges[section] = bInternalTimerSecond;
+
+				// Lit for the first half of every tick.
+				lights[LIGHT_TIMER_1 + section].setBrightnessSmooth(timersStarted[section] &&
+					elapsedSamples[section] < tickSamples / 2, args.sampleTime);
 			}
 
-			if (stResetInputs[section].process(inputs[INPUT_RESET_1 + section].getVoltage())) {
-				currentTimerValues[section] = setTimerValues[section];
+			if (triggeredResets & (1 << section)) {
+				resetTimer(section);
 			}
 
-			if (stRunInputs[section].process(inputs[INPUT_RUN_1 + section].getVoltage()) && currentTimerValues[section] > 0) {
-				timersStarted[section] = !timersStarted[section];
+			if ((triggeredRuns & (1 << section)) && currentTimerValues[section] > 0) {
+				toggleTimer(section);
 			}
 
-			if (stTriggerInputs[section].process(inputs[INPUT_TRIGGER_1 + section].getVoltage()) && timersStarted[section]) {
+			if ((triggeredTriggers & (1 << section)) && timersStarted[section]) {
 				pgTimerLights[section].trigger(0.05f);
 				decreaseTimer(section);
 			}
 
 			if (bIsControlsTurn) {
 				if (btResetButtons[section].process(params[PARAM_RESET_1 + section].getValue())) {
-					currentTimerValues[section] = setTimerValues[section];
+					resetTimer(section);
 				}
 
 				if (btRunButtons[section].process(params[PARAM_START_1 + section].getValue()) && currentTimerValues[section] > 0) {
-					timersStarted[section] = !timersStarted[section];
+					toggleTimer(section);
 				}
 
 				if (btTriggerButtons[section].process(params[PARAM_TRIGGER_1 + section].getValue()) && timersStarted[section]) {
@@ -203,6 +259,128 @@ struct Aion : SanguineModule {
 		}
 	}
 
+	void processPolyphonic(const ProcessArgs& args, const bool bIsControlsTurn) {
+		for (int section = 0; section < kModuleSections; ++section) {
+			int channelCount = std::max(std::max(inputs[INPUT_RUN_1 + section].getChannels(),
+				inputs[INPUT_TRIGGER_1 + section].getChannels()), std::max(inputs[INPUT_RESET_1 + section].getChannels(),
+					inputs[INPUT_DURATION_1 + section].getChannels()));
+			channelCount = std::max(channelCount, 1);
+			int channelsMask = (1 << channelCount) - 1;
+
+			int triggeredResets = stPolyResetInputs[section].processBroadcastInput(inputs[INPUT_RESET_1 + section], channelsMask);
+			int triggeredRuns = stPolyRunInputs[section].processBroadcastInput(inputs[INPUT_RUN_1 + section], channelsMask);
+			int triggeredTriggers = stPolyTriggerInputs[section].processBroadcastInput(inputs[INPUT_TRIGGER_1 + section], channelsMask);
+
+			bool bRestart = params[PARAM_RESTART_1 + section].getValue();
+
+			// Buttons act on every timer of the section.
+			if (bIsControlsTurn) {
+				if (btResetButtons[section].process(params[PARAM_RESET_1 + section].getValue())) {
+					triggeredResets = channelsMask;
+				}
+
+				if (btRunButtons[section].process(params[PARAM_START_1 + section].getValue())) {
+					triggeredRuns = channelsMask;
+				}
+
+				if (btTriggerButtons[section].process(params[PARAM_TRIGGER_1 + section].getValue())) {
+					triggeredTriggers = channelsMask;
+				}
+
+#ifdef METAMODULE
+				lights[LIGHT_RESTART_1 + section].setBrightness(params[PARAM_RESTART_1 + section].getValue() *
+					kSanguineButtonLightValue);
+#endif
+			}
+
+			if ((triggeredTriggers & 1) && (polyTimers[section][0].getStartedBits() & 1)) {
+				pgTimerLights[section].trigger(0.05f);
+			}
+
+			for (int channel = 0; channel < channelCount; channel += 4) {
+				aion::TimerBank4& timers = polyTimers[section][channel >> 2];
+
+				if (bIsControlsTurn) {
+					float_4 durations = params[PARAM_TIMER_1 + section].getValue() +
+						inputs[INPUT_DURATION_1 + section].getPolyVoltageSimd<float_4>(channel) * aion::kCountsPerVolt;
+					timers.setDurations(simd::clamp(simd::round(durations), aion::kMinTimerValue, aion::kMaxTimerValue));
+				}
+
+				timers.reset(aion::getLaneMask(triggeredResets >> channel));
+				timers.toggle(aion::getLaneMask(triggeredRuns >> channel));
+				if (!inputTriggers[section]) {
+					timers.tick(tickSamples, bRestart, endPulseSamples);
+				}
+				timers.advance(aion::getLaneMask(triggeredTriggers >> channel), bRestart, endPulseSamples);
+
+				outputs[OUTPUT_TRIGGER_1 + section].setVoltageSimd(timers.processEndPulses(), channel);
+			}
+			outputs[OUTPUT_TRIGGER_1 + section].setChannels(channelCount);
+
+			// The section light follows the first channel.
+			if (!inputTriggers[section]) {
+				const aion::TimerBank4& firstTimers = polyTimers[section][0];
+				lights[LIGHT_TIMER_1 + section].setBrightnessSmooth((firstTimers.getStartedBits() & 1) &&
+					firstTimers.elapsedSamples[0] < tickSamples / 2, args.sampleTime);
+			} else {
+				lights[LIGHT_TIMER_1 + section].setBrightnessSmooth(pgTimerLights[section].process(args.sampleTime), args.sampleTime);
+			}
+		}
+	}
+
+	void publishDisplaySnapshot() {
+		DisplaySnapshot& snapshot = displayBuffer.getWriteBuffer();
+
+		for (int section = 0; section < kModuleSections; ++section) {
+			snapshot.timerValues[section] = !bPolyphonic ? currentTimerValues[section] :
+				static_cast<int>(polyTimers[section][0].currentValues[0]);
+		}
+
+		displayBuffer.publish();
+	}
+
+	void resetTimer(const int section) {
+		currentTimerValues[section] = setTimerValues[section];
+		elapsedSamples[section] = 0;
+	}
+
+	void toggleTimer(const int section) {
+		timersStarted[section] = !timersStarted[section];
+		elapsedSamples[section] = 0;
+	}
+
+	void setTimeBase(const aion::TimeBases newTimeBase, const float sampleRate) {
+		timeBase = newTimeBase;
+		tickSamples = std::max(static_cast<int>(std::round(sampleRate * aion::timeBaseDurations[timeBase])), 1);
+		for (int section = 0; section < kModuleSections; ++section) {
+			elapsedSamples[section] = std::min(elapsedSamples[section], tickSamples - 1);
+		}
+	}
+
+	void requestTimeBase(const aion::TimeBases newTimeBase) {
+		pendingTimeBase = newTimeBase;
+		bHavePendingSettings.store(true, std::memory_order_release);
+	}
+
+	void requestPolyphonic(const bool bNewPolyphonic) {
+		bPendingPolyphonic = bNewPolyphonic;
+		bHavePendingSettings.store(true, std::memory_order_release);
+	}
+
+	void setPolyphonic(const bool bNewPolyphonic) {
+		bPolyphonic = bNewPolyphonic;
+		if (!bPolyphonic) {
+			for (int section = 0; section < kModuleSections; ++section) {
+				outputs[OUTPUT_TRIGGER_1 + section].setChannels(1);
+			}
+		}
+	}
+
+	void onSampleRateChange(const SampleRateChangeEvent& e) override {
+		setTimeBase(timeBase, e.sampleRate);
+		endPulseSamples = std::max(std::round(e.sampleRate * kEndPulseDuration), 1.f);
+	}
+
 	inline void decreaseTimer(int timerNum) {
 		--currentTimerValues[timerNum];
 
@@ -257,6 +435,20 @@ struct Aion : SanguineModule {
 		}
 		json_object_set_new(rootJ, "timersStarted", timersStartedJ);
 
+		setJsonInt(rootJ, "timeBase", static_cast<int>(pendingTimeBase));
+
+		setJsonBoolean(rootJ, "polyphonic", bPendingPolyphonic);
+
+		json_t* polyTimersStartedJ = json_array();
+		for (int section = 0; section < kModuleSections; ++section) {
+			int startedChannels = 0;
+			for (int group = 0; group < kChannelGroups; ++group) {
+				startedChannels |= polyTimers[section][group].getStartedBits() << (group * 4);
+			}
+			json_array_append_new(polyTimersStartedJ, json_integer(startedChannels));
+		}
+		json_object_set_new(rootJ, "polyTimersStarted", polyTimersStartedJ);
+
 		return rootJ;
 	}
 
@@ -269,10 +461,36 @@ struct Aion : SanguineModule {
 		json_array_foreach(timersStartedJ, idx, timerJ) {
 			timersStarted[idx] = json_boolean_value(timerJ);
 		}
+
+		json_int_t intValue;
+
+		if (getJsonInt(rootJ, "timeBase", intValue)) {
+			setTimeBase(static_cast<aion::TimeBases>(clamp(static_cast<int>(intValue), 0, aion::TIME_BASES_COUNT - 1)),
+				APP->engine->getSampleRate());
+			pendingTimeBase = timeBase;
+		}
+
+		bool bNewPolyphonic = false;
+		if (getJsonBoolean(rootJ, "polyphonic", bNewPolyphonic)) {
+			setPolyphonic(bNewPolyphonic);
+			bPendingPolyphonic = bPolyphonic;
+		}
+
+		json_t* polyTimersStartedJ = json_object_get(rootJ, "polyTimersStarted");
+		json_array_foreach(polyTimersStartedJ, idx, timerJ) {
+			if (idx < kModuleSections) {
+				int startedChannels = json_integer_value(timerJ);
+				for (int group = 0; group < kChannelGroups; ++group) {
+					polyTimers[idx][group].setStartedBits(startedChannels >> (group * 4));
+				}
+			}
+		}
 	}
 };
 
 struct AionWidget : SanguineModuleWidget {
+	Aion::DisplaySnapshot displaySnapshot = {};
+
 	explicit AionWidget(Aion* module) {
 		setModule(module);
 
@@ -315,6 +533,8 @@ struct AionWidget : SanguineModuleWidget {
 		addInput(createInputCentered<BananutPurple>(millimetersToPixelsVec(20.446, 51.545), module, Aion::INPUT_TRIGGER_1));
 		addInput(createInputCentered<BananutPurple>(millimetersToPixelsVec(34.161, 51.545), module, Aion::INPUT_RESET_1));
 
+		addInput(createInputCentered<BananutPurplePoly>(millimetersToPixelsVec(47.87, 30.146), module, Aion::INPUT_DURATION_1));
+
 		addOutput(createOutputCentered<BananutRed>(millimetersToPixelsVec(47.87, 51.545), module, Aion::OUTPUT_TRIGGER_1));
 
 		// Timer 2
@@ -344,6 +564,8 @@ struct AionWidget : SanguineModuleWidget {
 		addInput(createInputCentered<BananutPurple>(millimetersToPixelsVec(76.211, 51.545), module, Aion::INPUT_TRIGGER_2));
 		addInput(createInputCentered<BananutPurple>(millimetersToPixelsVec(90.026, 51.545), module, Aion::INPUT_RESET_2));
 
+		addInput(createInputCentered<BananutPurplePoly>(millimetersToPixelsVec(103.635, 30.146), module, Aion::INPUT_DURATION_2));
+
 		addOutput(createOutputCentered<BananutRed>(millimetersToPixelsVec(103.635, 51.545), module, Aion::OUTPUT_TRIGGER_2));
 
 		// Timer 3
@@ -373,6 +595,8 @@ struct AionWidget : SanguineModuleWidget {
 		addInput(createInputCentered<BananutPurple>(millimetersToPixelsVec(20.446, 97.748), module, Aion::INPUT_TRIGGER_3));
 		addInput(createInputCentered<BananutPurple>(millimetersToPixelsVec(34.261, 97.748), module, Aion::INPUT_RESET_3));
 
+		addInput(createInputCentered<BananutPurplePoly>(millimetersToPixelsVec(47.87, 76.346), module, Aion::INPUT_DURATION_3));
+
 		addOutput(createOutputCentered<BananutRed>(millimetersToPixelsVec(47.87, 97.748), module, Aion::OUTPUT_TRIGGER_3));
 
 		// Timer 4
@@ -402,6 +626,8 @@ struct AionWidget : SanguineModuleWidget {
 		addInput(createInputCentered<BananutPurple>(millimetersToPixelsVec(76.211, 97.748), module, Aion::INPUT_TRIGGER_4));
 		addInput(createInputCentered<BananutPurple>(millimetersToPixelsVec(90.026, 97.748), module, Aion::INPUT_RESET_4));
 
+		addInput(createInputCentered<BananutPurplePoly>(millimetersToPixelsVec(103.635, 76.346), module, Aion::INPUT_DURATION_4));
+
 		addOutput(createOutputCentered<BananutRed>(millimetersToPixelsVec(103.635, 97.748), module, Aion::OUTPUT_TRIGGER_4));
 
 #ifndef METAMODULE
@@ -414,12 +640,43 @@ struct AionWidget : SanguineModuleWidget {
 #endif
 
 		if (module) {
-			displayTimer1->values.numberValue = &module->currentTimerValues[0];
-			displayTimer2->values.numberValue = &module->currentTimerValues[1];
-			displayTimer3->values.numberValue = &module->currentTimerValues[2];
-			displayTimer4->values.numberValue = &module->currentTimerValues[3];
+			displayTimer1->values.numberValue = &displaySnapshot.timerValues[0];
+			displayTimer2->values.numberValue = &displaySnapshot.timerValues[1];
+			displayTimer3->values.numberValue = &displaySnapshot.timerValues[2];
+			displayTimer4->values.numberValue = &displaySnapshot.timerValues[3];
+		}
+	}
+
+	void appendContextMenu(Menu* menu) override {
+		SanguineModuleWidget::appendContextMenu(menu);
+
+		Aion* module = dynamic_cast<Aion*>(this->module);
+
+		menu->addChild(new MenuSeparator);
+
+		menu->addChild(createIndexSubmenuItem("Timer unit", aion::timeBaseLabels,
+			[=]() {return module->pendingTimeBase; },
+			[=](int i) {module->requestTimeBase(static_cast<aion::TimeBases>(i)); }
+		));
+
+		menu->addChild(createCheckMenuItem("Polyphonic timers", "",
+			[=]() {return module->bPendingPolyphonic; },
+			[=]() {module->requestPolyphonic(!module->bPendingPolyphonic); }));
+
+		if (!module->bPendingPolyphonic) {
+			menu->addChild(createMenuLabel("Duration CV inputs only work with polyphonic timers"));
 		}
 	}
+
+	void step() override {
+		Aion* aionModule = dynamic_cast<Aion*>(this->module);
+
+		if (aionModule && aionModule->displayBuffer.consume()) {
+			displaySnapshot = aionModule->displayBuffer.getReadBuffer();
+		}
+
+		SanguineModuleWidget::step();
+	}
 };
 
 Model* modelAion = createModel<Aion, AionWidget>("Sanguine-Aion");
\ No newline at end of file
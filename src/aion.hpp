@@ -0,0 +1,101 @@
+#pragma once
+
+using simd::float_4;
+
+namespace aion {
+    enum TimeBases {
+        TIME_BASE_SECONDS,
+        TIME_BASE_DECISECONDS,
+        TIME_BASE_CENTISECONDS,
+        TIME_BASE_MILLISECONDS,
+        TIME_BASES_COUNT
+    };
+
+    static const float timeBaseDurations[TIME_BASES_COUNT] = {
+        1.f,
+        0.1f,
+        0.01f,
+        0.001f
+    };
+
+    static const std::vector<std::string> timeBaseLabels = {
+        "Seconds",
+        "100 ms",
+        "10 ms",
+        "1 ms"
+    };
+
+    static const float kMinTimerValue = 1.f;
+    static const float kMaxTimerValue = 99.f;
+    // Timer counts added per volt of duration CV.
+    static const float kCountsPerVolt = 10.f;
+
+    // Lane mask with lane n set when bit n of bits is set.
+    inline float_4 getLaneMask(const int bits) {
+        return float_4(bits & 1, bits & 2, bits & 4, bits & 8) != 0.f;
+    }
+
+    /* Four polyphonic timers.
+       Lanes hold whole counts and whole samples, which floats represent exactly; masks are all bits set for true lanes. */
+    struct TimerBank4 {
+        float_4 setValues = kMinTimerValue;
+        float_4 currentValues = kMinTimerValue;
+        float_4 elapsedSamples = 0.f;
+        float_4 started = 0.f;
+        float_4 pulseSamples = 0.f;
+
+        // Timers whose duration changed restart from the new value, like the knob does.
+        void setDurations(const float_4 newSetValues) {
+            float_4 changedLanes = newSetValues != setValues;
+            currentValues = simd::ifelse(changedLanes, newSetValues, currentValues);
+            setValues = newSetValues;
+        }
+
+        void reset(const float_4 lanes) {
+            currentValues = simd::ifelse(lanes, setValues, currentValues);
+            elapsedSamples = simd::ifelse(lanes, 0.f, elapsedSamples);
+        }
+
+        void toggle(float_4 lanes) {
+            lanes = lanes & (currentValues > 0.f);
+            started = simd::ifelse(lanes, ~started, started);
+            elapsedSamples = simd::ifelse(lanes, 0.f, elapsedSamples);
+        }
+
+        // Started timers in lanes count down one; the ones reaching zero fire an end pulse.
+        void advance(float_4 lanes, const bool bRestart, const float endPulseSamples) {
+            lanes = lanes & started;
+            currentValues = simd::ifelse(lanes, currentValues - 1.f, currentValues);
+
+            float_4 endedLanes = lanes & (currentValues <= 0.f);
+            if (bRestart) {
+                currentValues = simd::ifelse(endedLanes, setValues, currentValues);
+            } else {
+                currentValues = simd::ifelse(endedLanes, 0.f, currentValues);
+                started = simd::ifelse(endedLanes, 0.f, started);
+            }
+            pulseSamples = simd::ifelse(endedLanes, endPulseSamples, pulseSamples);
+        }
+
+        void tick(const float tickSamples, const bool bRestart, const float endPulseSamples) {
+            elapsedSamples = simd::ifelse(started, elapsedSamples + 1.f, elapsedSamples);
+            float_4 dueLanes = started & (elapsedSamples >= tickSamples);
+            elapsedSamples = simd::ifelse(dueLanes, 0.f, elapsedSamples);
+            advance(dueLanes, bRestart, endPulseSamples);
+        }
+
+        float_4 processEndPulses() {
+            float_4 voltages = simd::ifelse(pulseSamples > 0.f, 10.f, 0.f);
+            pulseSamples = simd::fmax(pulseSamples - 1.f, 0.f);
+            return voltages;
+        }
+
+        int getStartedBits() const {
+            return simd::movemask(started);
+        }
+
+        void setStartedBits(const int bits) {
+            started = getLaneMask(bits);
+        }
+    };
+}
@@ -5,9 +5,13 @@
 #include "sanguinejson.hpp"
 
 #include "alchemist.hpp"
+#include "controlscanner.hpp"
+#include "mutesolo.hpp"
 #ifndef METAMODULE
 #include "alembic.hpp"
 #include "crucible.hpp"
+
+#include <atomic>
 #endif
 
 struct Alchemist : SanguineModule {
@@ -17,6 +21,7 @@ struct Alchemist : SanguineModule {
 		ENUMS(PARAM_MUTE, PORT_MAX_CHANNELS),
 		ENUMS(PARAM_SOLO, PORT_MAX_CHANNELS),
 		PARAM_MASTER_MUTE,
+		ENUMS(PARAM_PAN, PORT_MAX_CHANNELS),
 		PARAMS_COUNT
 	};
 
@@ -30,6 +35,8 @@ struct Alchemist : SanguineModule {
 	enum OutputIds {
 		OUTPUT_MONO_MIX,
 		OUTPUT_POLYPHONIC_MIX,
+		OUTPUT_LEFT,
+		OUTPUT_RIGHT,
 		OUTPUTS_COUNT
 	};
 
@@ -50,29 +57,22 @@ struct Alchemist : SanguineModule {
 
 	int channelCount = 0;
 
-	int soloCount = 0;
+	// Channels that reach the mix, before master mute.
+	int activeChannels = muteSolo::kAllChannels;
 
-	int exclusiveMuteChannel = -1;
-	int exclusiveSoloChannel = -1;
+	float gainRampStep = 1.f / (44100.f * alchemist::kGainRampDuration);
 
 #ifndef METAMODULE
 	int expanderMuteCount = 0;
 	int expanderSoloCount = 0;
 #endif
 
-	bool mutedChannels[PORT_MAX_CHANNELS] = {};
-	bool bLastAllMuted = false;
-
-	bool soloedChannels[PORT_MAX_CHANNELS] = {};
-	bool bLastAllSoloed = false;
-
 	bool bMonoOutConnected = false;
 	bool bPolyOutConnected = false;
+	bool bLeftOutConnected = false;
+	bool bRightOutConnected = false;
 
 #ifndef METAMODULE
-	bool bLastHaveExpanderMuteCv = false;
-	bool bLastHaveExpanderSoloCv = false;
-
 	bool bHaveRightExpander = false;
 	bool bHaveLeftExpander = false;
 
@@ -82,25 +82,44 @@ struct Alchemist : SanguineModule {
 	bool bHadLeftExpander = false;
 	bool bHadRightExpander = false;
 
-	bool bMuteAllEnabled = false;
-	bool bSoloAllEnabled = false;
+	/* Chaining is opt in: an Alchemist only adds the bus from an Alchemist on its left when bChainFromLeft is set,
+	   and only sends its bus right to an Alchemist that took it. The bus runs from left to right. */
+	bool bChainFromLeft = false;
+	bool bHaveLeftAlchemist = false;
+	bool bHaveRightAlchemist = false;
 
-	bool bMuteExclusiveEnabled = false;
-	bool bSoloExclusiveEnabled = false;
+	// Set from the UI thread, applied in process() so the left expander messages aren't swapped while in use.
+	bool bPendingChainFromLeft = false;
+	std::atomic<bool> bHavePendingChain{ false };
 
-	bool bHaveExpanderMuteCv = false;
-	bool bHaveExpanderSoloCv = false;
+	bool bLeftAlchemistAvailable = false;
+	bool bRightAlchemistAvailable = false;
+
+	// Set when a patch from before the 27 HP panel loads; the widget then pushes its right neighbours away.
+	bool bMakeRoomForPanel = false;
 #endif
 
 	dsp::ClockDivider lightsDivider;
 	dsp::VuMeter2 vuMeterMix;
 	dsp::VuMeter2 vuMetersGains[PORT_MAX_CHANNELS];
-	dsp::BooleanTrigger btMuteButtons[PORT_MAX_CHANNELS];
-	dsp::BooleanTrigger btSoloButtons[PORT_MAX_CHANNELS];
+
+	controlScanners::ButtonScanner<PORT_MAX_CHANNELS> muteButtons;
+	controlScanners::ButtonScanner<PORT_MAX_CHANNELS> soloButtons;
+
+	muteSolo::MuteSoloEngine muteSoloEngine;
+
+	alchemist::GainRamps gainRamps;
+
+	const alchemist::PanTable panTable;
+
+	float panLeftGains[PORT_MAX_CHANNELS] = {};
+	float panRightGains[PORT_MAX_CHANNELS] = {};
 
 #ifndef METAMODULE
-	Alembic* alembicExpander = nullptr;
-	Crucible* crucibleExpander = nullptr;
+	crucible::ControlsMessage crucibleMessages[2];
+	alembic::ControlsMessage alembicMessages[2];
+	// The left expander uses these instead of crucibleMessages while chained to an Alchemist on the left.
+	alchemist::BusMessage busMessages[2];
 #endif
 
 	float muteVoltages[PORT_MAX_CHANNELS] = {};
@@ -116,6 +135,7 @@ struct Alchemist : SanguineModule {
 			configParam(PARAM_GAIN + channel, 0.f, 1.f, 0.f, string::f("Channel %d gain", channelNumber), "%", 0.f, 100.f);
 			configButton(PARAM_MUTE + channel, string::f("Channel %d mute", channelNumber));
 			configButton(PARAM_SOLO + channel, string::f("Channel %d solo", channelNumber));
+			configParam(PARAM_PAN + channel, -1.f, 1.f, 0.f, string::f("Channel %d pan", channelNumber), "%", 0.f, 100.f);
 		}
 
 		configInput(INPUT_MASTER_MUTE, "Master mute CV");
@@ -129,15 +149,32 @@ struct Alchemist : SanguineModule {
 
 		configOutput(OUTPUT_POLYPHONIC_MIX, "Polyphonic mix");
 		configOutput(OUTPUT_MONO_MIX, "Monophonic mix");
+		configOutput(OUTPUT_LEFT, "Left mix");
+		configOutput(OUTPUT_RIGHT, "Right mix");
 
 		configBypass(INPUT_POLYPHONIC, OUTPUT_POLYPHONIC_MIX);
 
+#ifndef METAMODULE
+		leftExpander.producerMessage = &crucibleMessages[0];
+		leftExpander.consumerMessage = &crucibleMessages[1];
+
+		rightExpander.producerMessage = &alembicMessages[0];
+		rightExpander.consumerMessage = &alembicMessages[1];
+#endif
+
 		lightsDivider.setDivision(kLightsFrequency);
 	}
 
 #ifndef METAMODULE
 	void process(const ProcessArgs& args) override {
+		if (bHavePendingChain.exchange(false, std::memory_order_acquire)) {
+			bChainFromLeft = bPendingChainFromLeft;
+			updateLeftAlchemist();
+		}
+
 		float monoMix = 0.f;
+		float leftMix = 0.f;
+		float rightMix = 0.f;
 		float outVoltages[PORT_MAX_CHANNELS] = {};
 		float masterOutVoltages[PORT_MAX_CHANNELS] = {};
 		bool bMasterMuted = static_cast<bool>(params[PARAM_MASTER_MUTE].getValue()) | (inputs[INPUT_MASTER_MUTE].getVoltage() >= 1.f);
@@ -147,8 +184,12 @@ struct Alchemist : SanguineModule {
 
 		bool bIsLightsTurn = lightsDivider.process();
 
-		bLeftExpanderAvailable = bHaveLeftExpander && !(crucibleExpander->isBypassed());
-		bRightExpanderAvailable = bHaveRightExpander && !(alembicExpander->isBypassed());
+		bLeftExpanderAvailable = bHaveLeftExpander && !(leftExpander.module->isBypassed());
+		bRightExpanderAvailable = bHaveRightExpander && !(rightExpander.module->isBypassed());
+
+		bLeftAlchemistAvailable = bHaveLeftAlchemist && !(leftExpander.module->isBypassed());
+		bRightAlchemistAvailable = bHaveRightAlchemist && !(rightExpander.module->isBypassed()) &&
+			static_cast<Alchemist*>(rightExpander.module)->bHaveLeftAlchemist;
 
 		if (bHaveRightExpander) {
 			bHadRightExpander = true;
@@ -160,18 +201,7 @@ struct Alchemist : SanguineModule {
 			if (bIsLightsTurn) {
 				sampleTime = kLightsFrequency * args.sampleTime;
 
-				bool bIgnoreMuteAll = false;
-				bool bIgnoreSoloAll = false;
-
-				soloCount = 0;
-
-				for (int channel = 0; channel < PORT_MAX_CHANNELS; ++channel) {
-					handleMuteButtons(channel);
-
-					handleSoloButtons(channel);
-
-					handleSoloLogic(channel, bIgnoreMuteAll, bIgnoreSoloAll);
-				}
+				resolveMuteSolo();
 			}
 		} else {
 			bHadLeftExpander = true;
@@ -182,46 +212,16 @@ struct Alchemist : SanguineModule {
 				if (bIsLightsTurn) {
 					sampleTime = kLightsFrequency * args.sampleTime;
 
-					bool bIgnoreMuteAll = false;
-					bool bIgnoreSoloAll = false;
-
-					soloCount = 0;
-
-					for (int channel = 0; channel < PORT_MAX_CHANNELS; ++channel) {
-						handleMuteButtonsCrucicle(channel, bIgnoreMuteAll, bIgnoreSoloAll);
-
-						handleMuteVoltages(channel);
-
-						handleSoloButtonsCrucible(channel, bIgnoreMuteAll, bIgnoreSoloAll);
-
-						handleSoloVoltages(channel);
-
-						handleCrucibleLogic(channel, bIgnoreMuteAll, bIgnoreSoloAll);
-					}
-
-					setCrucibleValues();
-					setPreviousExpanderVoltages();
-
-					setCrucibleButtonLights(sampleTime);
+					resolveMuteSoloCrucible();
 				}
+
+				sendCrucibleStatus();
 			} else {
 				if (bIsLightsTurn) {
 					sampleTime = kLightsFrequency * args.sampleTime;
 
-					bool bIgnoreMuteAll = false;
-					bool bIgnoreSoloAll = false;
-
-					soloCount = 0;
-
-					for (int channel = 0; channel < PORT_MAX_CHANNELS; ++channel) {
-						handleMuteButtons(channel);
-
-						handleSoloButtons(channel);
-
-						handleSoloLogic(channel, bIgnoreMuteAll, bIgnoreSoloAll);
-					}
-
-					setPreviousExpanderVoltages();
+					resolveMuteSolo();
+					muteSoloEngine.setPreviousExpanderVoltages();
 				}
 			}
 		}
@@ -229,11 +229,11 @@ struct Alchemist : SanguineModule {
 		if (!bRightExpanderAvailable) {
 			inputs[INPUT_POLYPHONIC].readVoltages(outVoltages);
 
-			processChannels(outVoltages, masterOutVoltages, mixModulation, monoMix, bMasterMuted);
+			processChannels(outVoltages, masterOutVoltages, mixModulation, monoMix, leftMix, rightMix, bMasterMuted);
 
-			modulateMonoSignal(monoMix, mixModulation);
+			modulateMix(monoMix, leftMix, rightMix, mixModulation);
 
-			setOutputs(monoMix, masterOutVoltages);
+			setOutputs(monoMix, leftMix, rightMix, masterOutVoltages);
 
 			if (bIsLightsTurn) {
 				setLights(sampleTime, outVoltages, monoMix, bMasterMuted);
@@ -241,11 +241,14 @@ struct Alchemist : SanguineModule {
 		} else {
 			inputs[INPUT_POLYPHONIC].readVoltages(outVoltages);
 
-			processChannelsAlembic(outVoltages, masterOutVoltages, mixModulation, monoMix, bMasterMuted);
+			processChannelsAlembic(outVoltages, masterOutVoltages, mixModulation, monoMix, leftMix, rightMix,
+				bMasterMuted);
+
+			modulateMix(monoMix, leftMix, rightMix, mixModulation);
 
-			modulateMonoSignal(monoMix, mixModulation);
+			setOutputs(monoMix, leftMix, rightMix, masterOutVoltages);
 
-			setOutputs(monoMix, masterOutVoltages);
+			sendAlembicOutputs(masterOutVoltages);
 
 			if (bIsLightsTurn) {
 				setLights(sampleTime, outVoltages, monoMix, bMasterMuted);
@@ -255,6 +258,8 @@ struct Alchemist : SanguineModule {
 #else
 	void process(const ProcessArgs& args) override {
 		float monoMix = 0.f;
+		float leftMix = 0.f;
+		float rightMix = 0.f;
 		float outVoltages[PORT_MAX_CHANNELS] = {};
 		float masterOutVoltages[PORT_MAX_CHANNELS] = {};
 		bool bMasterMuted = static_cast<bool>(params[PARAM_MASTER_MUTE].getValue()) | (inputs[INPUT_MASTER_MUTE].getVoltage() >= 1.f);
@@ -265,27 +270,16 @@ struct Alchemist : SanguineModule {
 		bool bIsLightsTurn = lightsDivider.process();
 
 		if (bIsLightsTurn) {
-			bool bIgnoreMuteAll = false;
-			bool bIgnoreSoloAll = false;
-
-			soloCount = 0;
-
-			for (int channel = 0; channel < PORT_MAX_CHANNELS; ++channel) {
-				handleMuteButtons(channel);
-
-				handleSoloButtons(channel);
-
-				handleSoloLogic(channel, bIgnoreMuteAll, bIgnoreSoloAll);
-			}
+			resolveMuteSolo();
 		}
 
 		inputs[INPUT_POLYPHONIC].readVoltages(outVoltages);
 
-		processChannels(outVoltages, masterOutVoltages, mixModulation, monoMix, bMasterMuted);
+		processChannels(outVoltages, masterOutVoltages, mixModulation, monoMix, leftMix, rightMix, bMasterMuted);
 
-		modulateMonoSignal(monoMix, mixModulation);
+		modulateMix(monoMix, leftMix, rightMix, mixModulation);
 
-		setOutputs(monoMix, masterOutVoltages);
+		setOutputs(monoMix, leftMix, rightMix, masterOutVoltages);
 
 		if (bIsLightsTurn) {
 			const float sampleTime = kLightsFrequency * args.sampleTime;
@@ -295,13 +289,19 @@ struct Alchemist : SanguineModule {
 	}
 #endif
 
-	void processChannels(float* outVoltages, float* masterOutVoltages,
-		const float mixModulation, float& monoMix, const bool masterMuted) {
+	void processChannels(float* outVoltages, float* masterOutVoltages, const float mixModulation,
+		float& monoMix, float& leftMix, float& rightMix, const bool masterMuted) {
 		for (int channel = 0; channel < channelCount; ++channel) {
 			applyChannelGain(outVoltages, channel);
+		}
 
-			mixChannel(outVoltages, channel, masterOutVoltages, mixModulation, monoMix, masterMuted);
+		if (needsStereoSums()) {
+			for (int channel = 0; channel < channelCount; ++channel) {
+				setPanGains(channel, params[PARAM_PAN + channel].getValue());
+			}
 		}
+
+		mixChannels(outVoltages, masterOutVoltages, mixModulation, monoMix, leftMix, rightMix, masterMuted);
 	}
 
 	void applyChannelGain(float* outVoltages, const int channel) {
@@ -312,23 +312,90 @@ struct Alchemist : SanguineModule {
 		}
 	}
 
-	void mixChannel(float* outVoltages, const int channel, float* masterOutVoltages,
-		const float mixModulation, float& monoMix, const bool masterMuted) {
-		if (!mutedChannels[channel] && ((soloCount == 0) | soloedChannels[channel]) && !masterMuted) {
-			monoMix += outVoltages[channel];
-			masterOutVoltages[channel] = outVoltages[channel] * mixModulation;
+	// Stereo sums feed the stereo outputs and the Alchemist on the right.
+	bool needsStereoSums() const {
+#ifndef METAMODULE
+		return bLeftOutConnected || bRightOutConnected || bRightAlchemistAvailable;
+#else
+		return bLeftOutConnected || bRightOutConnected;
+#endif
+	}
+
+	void setPanGains(const int channel, const float pan) {
+		panTable.getGains(clamp(pan, -1.f, 1.f), panLeftGains[channel], panRightGains[channel]);
+	}
+
+	// Channels above channelCount are silent in outVoltages, so whole blocks of four can be mixed.
+	void mixChannels(const float* outVoltages, float* masterOutVoltages, const float mixModulation,
+		float& monoMix, float& leftMix, float& rightMix, const bool masterMuted) {
+		gainRamps.process(masterMuted ? 0 : activeChannels, gainRampStep);
+
+		const bool bStereoSums = needsStereoSums();
+
+		float_4 monoMixes = 0.f;
+		float_4 leftMixes = 0.f;
+		float_4 rightMixes = 0.f;
+
+		for (int channel = 0; channel < channelCount; channel += 4) {
+			float_4 voltages = float_4::load(outVoltages + channel) * gainRamps.gains[channel >> 2];
+			monoMixes += voltages;
+			(voltages * mixModulation).store(masterOutVoltages + channel);
+
+			if (bStereoSums) {
+				leftMixes += voltages * float_4::load(panLeftGains + channel);
+				rightMixes += voltages * float_4::load(panRightGains + channel);
+			}
+		}
+
+		monoMix = monoMixes[0] + monoMixes[1] + monoMixes[2] + monoMixes[3];
+
+		if (bStereoSums) {
+			leftMix = leftMixes[0] + leftMixes[1] + leftMixes[2] + leftMixes[3];
+			rightMix = rightMixes[0] + rightMixes[1] + rightMixes[2] + rightMixes[3];
 		}
 	}
 
-	void modulateMonoSignal(float& monoMix, const float mixModulation) {
+	/* Applies the master mix and adds the bus from a chained Alchemist on the left.
+	   The Alchemist on the right gets the sums before saturation, so only the outputs are saturated. */
+	void modulateMix(float& monoMix, float& leftMix, float& rightMix, const float mixModulation) {
 		monoMix = monoMix * mixModulation;
+		leftMix = leftMix * mixModulation;
+		rightMix = rightMix * mixModulation;
+
+#ifndef METAMODULE
+		if (bLeftAlchemistAvailable) {
+			const alchemist::BusMessage* busMessage =
+				static_cast<alchemist::BusMessage*>(leftExpander.consumerMessage);
+
+			monoMix += busMessage->monoMix;
+			leftMix += busMessage->leftMix;
+			rightMix += busMessage->rightMix;
+		}
+
+		if (bRightAlchemistAvailable) {
+			alchemist::BusMessage* busMessage =
+				static_cast<alchemist::BusMessage*>(rightExpander.module->leftExpander.producerMessage);
+
+			busMessage->monoMix = monoMix;
+			busMessage->leftMix = leftMix;
+			busMessage->rightMix = rightMix;
+
+			rightExpander.module->leftExpander.requestMessageFlip();
+		}
+#endif
+
+		saturateMix(monoMix);
+		saturateMix(leftMix);
+		saturateMix(rightMix);
+	}
 
-		if (std::fabs(monoMix) >= 10.1f) {
-			monoMix = saturatorFloat.next(monoMix);
+	void saturateMix(float& mix) {
+		if (std::fabs(mix) >= 10.1f) {
+			mix = saturatorFloat.next(mix);
 		}
 	}
 
-	void setOutputs(const float monoMix, const float* masterOutVoltages) {
+	void setOutputs(const float monoMix, const float leftMix, const float rightMix, const float* masterOutVoltages) {
 		if (bMonoOutConnected) {
 			outputs[OUTPUT_MONO_MIX].setVoltage(monoMix);
 		}
@@ -337,6 +404,14 @@ struct Alchemist : SanguineModule {
 			outputs[OUTPUT_POLYPHONIC_MIX].writeVoltages(masterOutVoltages);
 			outputs[OUTPUT_POLYPHONIC_MIX].setChannels(channelCount);
 		}
+
+		if (bLeftOutConnected) {
+			outputs[OUTPUT_LEFT].setVoltage(leftMix);
+		}
+
+		if (bRightOutConnected) {
+			outputs[OUTPUT_RIGHT].setVoltage(rightMix);
+		}
 	}
 
 	void setLights(const float sampleTime, float* outVoltages, const float monoMix, const bool masterMuted) {
@@ -352,9 +427,9 @@ struct Alchemist : SanguineModule {
 			lights[currentLight].setBrightness(greenValue * (!bLightIsRed));
 			lights[currentLight + 1].setBrightness((yellowValue * (!bLightIsRed)) + redValue);
 
-			lights[LIGHT_MUTE + channel].setBrightnessSmooth(mutedChannels[channel] *
+			lights[LIGHT_MUTE + channel].setBrightnessSmooth(((muteSoloEngine.mutedChannels >> channel) & 1) *
 				kSanguineButtonLightValue, sampleTime);
-			lights[LIGHT_SOLO + channel].setBrightnessSmooth(soloedChannels[channel] *
+			lights[LIGHT_SOLO + channel].setBrightnessSmooth(((muteSoloEngine.soloedChannels >> channel) & 1) *
 				kSanguineButtonLightValue, sampleTime);
 		}
 
@@ -366,9 +441,9 @@ struct Alchemist : SanguineModule {
 			lights[currentLight].setBrightness(0.f);
 			lights[currentLight + 1].setBrightness(0.f);
 
-			lights[LIGHT_MUTE + channel].setBrightnessSmooth(mutedChannels[channel] *
+			lights[LIGHT_MUTE + channel].setBrightnessSmooth(((muteSoloEngine.mutedChannels >> channel) & 1) *
 				kSanguineButtonLightValue, sampleTime);
-			lights[LIGHT_SOLO + channel].setBrightnessSmooth(soloedChannels[channel] *
+			lights[LIGHT_SOLO + channel].setBrightnessSmooth(((muteSoloEngine.soloedChannels >> channel) & 1) *
 				kSanguineButtonLightValue, sampleTime);
 		}
 
@@ -380,66 +455,41 @@ struct Alchemist : SanguineModule {
 		lights[LIGHT_MASTER_MUTE].setBrightnessSmooth(masterMuted * kSanguineButtonLightValue, sampleTime);
 
 #ifndef METAMODULE
-		lights[LIGHT_EXPANDER_RIGHT].setBrightnessSmooth(bRightExpanderAvailable * kSanguineButtonLightValue, sampleTime);
-		lights[LIGHT_EXPANDER_LEFT].setBrightnessSmooth(bLeftExpanderAvailable * kSanguineButtonLightValue, sampleTime);
+		lights[LIGHT_EXPANDER_RIGHT].setBrightnessSmooth((bRightExpanderAvailable || bRightAlchemistAvailable) *
+			kSanguineButtonLightValue, sampleTime);
+		lights[LIGHT_EXPANDER_LEFT].setBrightnessSmooth((bLeftExpanderAvailable || bLeftAlchemistAvailable) *
+			kSanguineButtonLightValue, sampleTime);
 #endif
 	}
 
-	void handleMuteButtons(const int channel) {
-		if (btMuteButtons[channel].process(params[PARAM_MUTE + channel].getValue())) {
-			mutedChannels[channel] = !mutedChannels[channel];
-
-			if (soloedChannels[channel]) {
-				soloedChannels[channel] = false;
-			}
-		}
-	}
-
-	void handleSoloButtons(const int channel) {
-		if (btSoloButtons[channel].process(params[PARAM_SOLO + channel].getValue())) {
-			soloedChannels[channel] = !soloedChannels[channel];
-
-			if (mutedChannels[channel]) {
-				mutedChannels[channel] = false;
-			}
-		}
-	}
-
-	void handleSoloLogic(const int channel, const bool ignoreMuteAll, const bool ignoreSoloAll) {
-		if (soloedChannels[channel]) {
-			++soloCount;
+	void resolveMuteSolo() {
+		muteSoloEngine.resolve(muteButtons.scan(params, PARAM_MUTE), soloButtons.scan(params, PARAM_SOLO));
 
-			if (mutedChannels[channel]) {
-				mutedChannels[channel] = false;
-			}
-		}
+		activeChannels = muteSoloEngine.getActiveChannels();
 	}
 
 #ifndef METAMODULE
-	void processChannelsAlembic(float* outVoltages, float* masterOutVoltages,
-		const float mixModulation, float& monoMix, const bool masterMuted) {
-		for (int channel = 0; channel < channelCount; ++channel) {
-			applyChannelGainAlembic(outVoltages, channel);
-
-			mixChannel(outVoltages, channel, masterOutVoltages, mixModulation, monoMix, masterMuted);
+	void processChannelsAlembic(float* outVoltages, float* masterOutVoltages, const float mixModulation,
+		float& monoMix, float& leftMix, float& rightMix, const bool masterMuted) {
+		const alembic::ControlsMessage* controlsMessage =
+			static_cast<alembic::ControlsMessage*>(rightExpander.consumerMessage);
 
-			Output& output = alembicExpander->getOutput(Alembic::OUTPUT_CHANNEL + channel);
-			if (alembicExpander->getOutputConnected(channel)) {
-				output.setVoltage(masterOutVoltages[channel]);
-			}
+		for (int channel = 0; channel < channelCount; ++channel) {
+			applyChannelGainAlembic(outVoltages, channel, controlsMessage->gainVoltages[channel]);
 		}
 
-		for (int channel = channelCount; channel < PORT_MAX_CHANNELS; ++channel) {
-			Output& output = alembicExpander->getOutput(Alembic::OUTPUT_CHANNEL + channel);
-			if (alembicExpander->getOutputConnected(channel)) {
-				output.setVoltage(masterOutVoltages[channel]);
+		if (needsStereoSums()) {
+			for (int channel = 0; channel < channelCount; ++channel) {
+				setPanGains(channel, params[PARAM_PAN + channel].getValue() + controlsMessage->panVoltages[channel] / 5.f);
 			}
 		}
+
+		mixChannels(outVoltages, masterOutVoltages, mixModulation, monoMix, leftMix, rightMix, masterMuted);
 	}
 
-	void applyChannelGainAlembic(float* outVoltages, const int channel) {
+	void applyChannelGainAlembic(float* outVoltages, const int channel, const float gainVoltage) {
 		outVoltages[channel] = outVoltages[channel] * clamp(params[PARAM_GAIN + channel].getValue() +
-			alembicExpander->getInput(Alembic::INPUT_GAIN_CV + channel).getVoltage() / 5.f, 0.f, 2.f);
+			gainVoltage / 5.f, 0.f, 2.f);
 
 		if (std::fabs(outVoltages[channel]) >= 10.f) {
 			outVoltages[channel] = saturatorFloat.next(outVoltages[channel]);
@@ -447,229 +497,136 @@ struct Alchemist : SanguineModule {
 	}
 
 	void readCrucibleControls() {
-		bMuteExclusiveEnabled = static_cast<bool>(crucibleExpander->getParam(Crucible::PARAM_MUTE_EXCLUSIVE).getValue());
-		bSoloExclusiveEnabled = static_cast<bool>(crucibleExpander->getParam(Crucible::PARAM_SOLO_EXCLUSIVE).getValue());
+		const crucible::ControlsMessage* controlsMessage =
+			static_cast<crucible::ControlsMessage*>(leftExpander.consumerMessage);
 
-		bMuteAllEnabled = !bMuteExclusiveEnabled &&
-			(static_cast<bool>(crucibleExpander->getParam(Crucible::PARAM_MUTE_ALL).getValue()) |
-				(crucibleExpander->getInput(Crucible::INPUT_MUTE_ALL).getVoltage() >= 1.f));
-		bSoloAllEnabled = !bSoloExclusiveEnabled &&
-			(static_cast<bool>(crucibleExpander->getParam(Crucible::PARAM_SOLO_ALL).getValue()) |
-				(crucibleExpander->getInput(Crucible::INPUT_SOLO_ALL).getVoltage() >= 1.f));
+		muteSoloEngine.bMuteExclusiveEnabled = controlsMessage->bMuteExclusive;
+		muteSoloEngine.bSoloExclusiveEnabled = controlsMessage->bSoloExclusive;
 
-		if (bMuteExclusiveEnabled) {
-			crucibleExpander->getParam(Crucible::PARAM_MUTE_ALL).setValue(0.f);
-		}
-
-		if (bSoloExclusiveEnabled) {
-			crucibleExpander->getParam(Crucible::PARAM_SOLO_ALL).setValue(0.f);
-		}
+		muteSoloEngine.bMuteAllEnabled = !controlsMessage->bMuteExclusive && controlsMessage->bMuteAll;
+		muteSoloEngine.bSoloAllEnabled = !controlsMessage->bSoloExclusive && controlsMessage->bSoloAll;
 
-		expanderMuteCount = crucibleExpander->getInput(Crucible::INPUT_MUTE_POLY).getChannels();
-		expanderSoloCount = crucibleExpander->getInput(Crucible::INPUT_SOLO_POLY).getChannels();
+		expanderMuteCount = controlsMessage->muteChannelCount;
+		expanderSoloCount = controlsMessage->soloChannelCount;
 
-		bHaveExpanderMuteCv = expanderMuteCount > 0;
-		bHaveExpanderSoloCv = expanderSoloCount > 0;
+		muteSoloEngine.bHaveExpanderMuteCv = expanderMuteCount > 0;
+		muteSoloEngine.bHaveExpanderSoloCv = expanderSoloCount > 0;
 
 		if (expanderMuteCount > 0) {
-			crucibleExpander->getInput(Crucible::INPUT_MUTE_POLY).readVoltages(muteVoltages);
+			memcpy(muteVoltages, controlsMessage->muteVoltages, sizeof(float) * expanderMuteCount);
 		}
 
 		if (expanderSoloCount > 0) {
-			crucibleExpander->getInput(Crucible::INPUT_SOLO_POLY).readVoltages(soloVoltages);
+			memcpy(soloVoltages, controlsMessage->soloVoltages, sizeof(float) * expanderSoloCount);
 		}
 	}
 
-	void setCrucibleButtonLights(const float sampleTime) {
-		crucibleExpander->getLight(Crucible::LIGHT_MUTE_ALL).setBrightnessSmooth(bMuteAllEnabled *
-			kSanguineButtonLightValue, sampleTime);
-		crucibleExpander->getLight(Crucible::LIGHT_SOLO_ALL).setBrightnessSmooth(bSoloAllEnabled *
-			kSanguineButtonLightValue, sampleTime);
-		crucibleExpander->getLight(Crucible::LIGHT_MUTE_EXCLUSIVE).setBrightnessSmooth(bMuteExclusiveEnabled *
-			kSanguineButtonLightValue, sampleTime);
-		crucibleExpander->getLight(Crucible::LIGHT_SOLO_EXCLUSIVE).setBrightnessSmooth(bSoloExclusiveEnabled *
-			kSanguineButtonLightValue, sampleTime);
-	}
-
-	void handleMuteButtonsCrucicle(const int channel, bool& ignoreMuteAll, bool& ignoreSoloAll) {
-		if (btMuteButtons[channel].process(params[PARAM_MUTE + channel].getValue())) {
-			mutedChannels[channel] = !mutedChannels[channel];
+	void sendCrucibleStatus() {
+		crucible::StatusMessage* statusMessage =
+			static_cast<crucible::StatusMessage*>(leftExpander.module->rightExpander.producerMessage);
 
-			if (soloedChannels[channel]) {
-				soloedChannels[channel] = false;
-			}
+		statusMessage->bMuteAllEnabled = muteSoloEngine.bMuteAllEnabled;
+		statusMessage->bMuteExclusiveEnabled = muteSoloEngine.bMuteExclusiveEnabled;
+		statusMessage->bSoloAllEnabled = muteSoloEngine.bSoloAllEnabled;
+		statusMessage->bSoloExclusiveEnabled = muteSoloEngine.bSoloExclusiveEnabled;
 
-			if ((bMuteAllEnabled && bLastAllMuted) && !mutedChannels[channel]) {
-				bMuteAllEnabled = false;
-				crucibleExpander->getParam(Crucible::PARAM_MUTE_ALL).setValue(0.f);
-				ignoreMuteAll = true;
-			}
+		statusMessage->bClearMuteAll = muteSoloEngine.bClearCrucibleMuteAll;
+		statusMessage->bClearSoloAll = muteSoloEngine.bClearCrucibleSoloAll;
 
-			if ((bSoloAllEnabled && bLastAllSoloed)) {
-				bSoloAllEnabled = false;
-				crucibleExpander->getParam(Crucible::PARAM_SOLO_ALL).setValue(0.f);
-				ignoreSoloAll = true;
-			}
+		leftExpander.module->rightExpander.requestMessageFlip();
 
-			if (exclusiveMuteChannel != channel) {
-				exclusiveMuteChannel = channel;
-			} else {
-				exclusiveMuteChannel = -1;
-			}
-		}
-	}
-
-	void handleMuteVoltages(const int channel) {
-		if (expanderMuteCount > 0 && channel < channelCount) {
-			mutedChannels[channel] = muteVoltages[channel] >= 1.f;
-			exclusiveMuteChannel = -1;
-		}
+		muteSoloEngine.bClearCrucibleMuteAll = false;
+		muteSoloEngine.bClearCrucibleSoloAll = false;
 	}
 
-	void handleSoloButtonsCrucible(const int channel, bool& ignoreMuteAll, bool& ignoreSoloAll) {
-		if (btSoloButtons[channel].process(params[PARAM_SOLO + channel].getValue())) {
-			soloedChannels[channel] = !soloedChannels[channel];
-
-			if (mutedChannels[channel]) {
-				mutedChannels[channel] = false;
-			}
-
-			if ((bMuteAllEnabled && bLastAllMuted)) {
-				bMuteAllEnabled = false;
-				crucibleExpander->getParam(Crucible::PARAM_MUTE_ALL).setValue(0.f);
-				ignoreMuteAll = true;
-			}
+	void sendAlembicOutputs(const float* masterOutVoltages) {
+		alembic::OutputsMessage* outputsMessage =
+			static_cast<alembic::OutputsMessage*>(rightExpander.module->leftExpander.producerMessage);
 
-			if ((bSoloAllEnabled && bLastAllSoloed) && !soloedChannels[channel]) {
-				bSoloAllEnabled = false;
-				crucibleExpander->getParam(Crucible::PARAM_SOLO_ALL).setValue(0.f);
-				ignoreSoloAll = true;
-			}
-
-			if (exclusiveSoloChannel != channel) {
-				exclusiveSoloChannel = channel;
-			} else {
-				exclusiveSoloChannel = -1;
-			}
-		}
-	}
+		memcpy(outputsMessage->outputVoltages, masterOutVoltages, sizeof(float) * PORT_MAX_CHANNELS);
 
-	void handleSoloVoltages(const int channel) {
-		if (expanderSoloCount > 0 && channel < channelCount) {
-			soloedChannels[channel] = soloVoltages[channel] >= 1.f;
-			exclusiveSoloChannel = -1;
-		}
+		rightExpander.module->leftExpander.requestMessageFlip();
 	}
 
-	void handleCrucibleLogic(const int channel, const bool ignoreMuteAll, const bool ignoreSoloAll) {
-		if (!bMuteExclusiveEnabled && !ignoreMuteAll && ((bLastAllMuted != bMuteAllEnabled) |
-			(bLastHaveExpanderMuteCv != bHaveExpanderMuteCv))) {
-			mutedChannels[channel] = bMuteAllEnabled;
-		}
-
-		if (!bSoloExclusiveEnabled && !ignoreSoloAll && ((bLastAllSoloed != bSoloAllEnabled) |
-			(bLastHaveExpanderSoloCv != bHaveExpanderSoloCv))) {
-			soloedChannels[channel] = bSoloAllEnabled;
-		}
-
-		if (bMuteExclusiveEnabled) {
-			if (channel != exclusiveMuteChannel && exclusiveMuteChannel >= 0) {
-				mutedChannels[channel] = false;
-			}
-		}
-
-		if (bSoloExclusiveEnabled) {
-			if (channel != exclusiveSoloChannel && exclusiveSoloChannel >= 0) {
-				soloedChannels[channel] = false;
-			}
-		}
+	void resolveMuteSoloCrucible() {
+		muteSoloEngine.resolveCrucible(muteButtons.scan(params, PARAM_MUTE), soloButtons.scan(params, PARAM_SOLO),
+			getHighChannels(muteVoltages), getHighChannels(soloVoltages), channelCount);
+		muteSoloEngine.setPreviousExpanderVoltages();
 
-		if (soloedChannels[channel]) {
-			++soloCount;
-
-			if (mutedChannels[channel]) {
-				mutedChannels[channel] = false;
-			}
-		}
+		activeChannels = muteSoloEngine.getActiveChannels();
 	}
 
-	void setPreviousExpanderVoltages() {
-		bLastHaveExpanderMuteCv = bHaveExpanderMuteCv;
-		bLastHaveExpanderSoloCv = bHaveExpanderSoloCv;
-	}
-
-	void setCrucibleValues() {
-		if (bLastAllMuted != bMuteAllEnabled) {
-			bLastAllMuted = bMuteAllEnabled;
-
-			if (bMuteAllEnabled) {
-				memset(mutedChannels, true, sizeof(bool) * PORT_MAX_CHANNELS);
-				memset(soloedChannels, false, sizeof(bool) * PORT_MAX_CHANNELS);
-			}
-
-			if (bSoloAllEnabled) {
-				bSoloAllEnabled = false;
-				bLastAllSoloed = false;
-				crucibleExpander->getParam(Crucible::PARAM_SOLO_ALL).setValue(0.f);
-			}
-		}
-
-		if (bLastAllSoloed != bSoloAllEnabled) {
-			bLastAllSoloed = bSoloAllEnabled;
-
-			if (bSoloAllEnabled) {
-				memset(soloedChannels, true, sizeof(bool) * PORT_MAX_CHANNELS);
-				memset(mutedChannels, false, sizeof(bool) * PORT_MAX_CHANNELS);
-			}
-
-			if (bMuteAllEnabled) {
-				bMuteAllEnabled = false;
-				bLastAllMuted = false;
-				crucibleExpander->getParam(Crucible::PARAM_MUTE_ALL).setValue(0.f);
-			}
+	// Bit n set when voltage n is high.
+	static int getHighChannels(const float* voltages) {
+		int highChannels = 0;
+		for (int channel = 0; channel < PORT_MAX_CHANNELS; channel += 4) {
+			highChannels |= simd::movemask(simd::float_4::load(voltages + channel) >= 1.f) << channel;
 		}
+		return highChannels;
 	}
 
 	void onBypass(const BypassEvent& e) override {
 		if (bHaveRightExpander) {
-			alembicExpander->getLight(Alembic::LIGHT_MASTER_MODULE).setBrightness(0.f);
+			rightExpander.module->getLight(Alembic::LIGHT_MASTER_MODULE).setBrightness(0.f);
 		}
 
 		if (bHaveLeftExpander) {
-			crucibleExpander->getLight(Crucible::LIGHT_MASTER_MODULE).setBrightness(0.f);
+			leftExpander.module->getLight(Crucible::LIGHT_MASTER_MODULE).setBrightness(0.f);
 		}
 		Module::onBypass(e);
 	}
 
 	void onUnBypass(const UnBypassEvent& e) override {
 		if (bHaveRightExpander) {
-			alembicExpander->getLight(Alembic::LIGHT_MASTER_MODULE).setBrightness(kSanguineButtonLightValue);
+			rightExpander.module->getLight(Alembic::LIGHT_MASTER_MODULE).setBrightness(kSanguineButtonLightValue);
 		}
 
 		if (bHaveLeftExpander) {
-			crucibleExpander->getLight(Crucible::LIGHT_MASTER_MODULE).setBrightness(kSanguineButtonLightValue);
+			leftExpander.module->getLight(Crucible::LIGHT_MASTER_MODULE).setBrightness(kSanguineButtonLightValue);
 		}
 		Module::onUnBypass(e);
 	}
 
+	void updateLeftAlchemist() {
+		Module* leftModule = getLeftExpander().module;
+		bool bLeftAlchemist = bChainFromLeft && leftModule && leftModule->getModel() == modelAlchemist;
+		if (bLeftAlchemist != bHaveLeftAlchemist) {
+			bHaveLeftAlchemist = bLeftAlchemist;
+
+			if (bHaveLeftAlchemist) {
+				busMessages[0] = alchemist::BusMessage();
+				busMessages[1] = alchemist::BusMessage();
+
+				leftExpander.producerMessage = &busMessages[0];
+				leftExpander.consumerMessage = &busMessages[1];
+			} else {
+				leftExpander.producerMessage = &crucibleMessages[0];
+				leftExpander.consumerMessage = &crucibleMessages[1];
+			}
+		}
+	}
+
+	void requestChainFromLeft(const bool bChain) {
+		bPendingChainFromLeft = bChain;
+		bHavePendingChain.store(true, std::memory_order_release);
+	}
+
 	void onExpanderChange(const ExpanderChangeEvent& e) override {
 		if (e.side == 0) {
 			Module* leftModule = getLeftExpander().module;
 			bHaveLeftExpander = leftModule && leftModule->getModel() == modelCrucible &&
 				!leftModule->isBypassed();
 
-			if (bHaveLeftExpander) {
-				crucibleExpander = dynamic_cast<Crucible*>(leftModule);
-			}
+			updateLeftAlchemist();
 
 			if (!bHadLeftExpander && (bHadLeftExpander != bHaveLeftExpander)) {
-				exclusiveMuteChannel = -1;
-				exclusiveSoloChannel = -1;
+				muteSoloEngine.exclusiveMuteChannel = -1;
+				muteSoloEngine.exclusiveSoloChannel = -1;
 
-				bMuteAllEnabled = false;
-				bSoloAllEnabled = false;
-				bMuteExclusiveEnabled = false;
-				bSoloExclusiveEnabled = false;
+				muteSoloEngine.bMuteAllEnabled = false;
+				muteSoloEngine.bSoloAllEnabled = false;
+				muteSoloEngine.bMuteExclusiveEnabled = false;
+				muteSoloEngine.bSoloExclusiveEnabled = false;
 
 				for (int channel = 0; channel < PORT_MAX_CHANNELS; ++channel) {
 					muteVoltages[channel] = 0.f;
@@ -684,13 +641,15 @@ struct Alchemist : SanguineModule {
 			bHaveRightExpander = rightModule && rightModule->getModel() == modelAlembic &&
 				!rightModule->isBypassed();
 
-			if (bHaveRightExpander) {
-				alembicExpander = dynamic_cast<Alembic*>(rightModule);
-			}
+			bHaveRightAlchemist = rightModule && rightModule->getModel() == modelAlchemist;
 		}
 	}
 #endif
 
+	void onSampleRateChange(const SampleRateChangeEvent& e) override {
+		gainRampStep = 1.f / (e.sampleRate * alchemist::kGainRampDuration);
+	}
+
 	void onPortChange(const PortChangeEvent& e) override {
 		if (e.type == Port::OUTPUT) {
 			switch (e.portId) {
@@ -701,10 +660,22 @@ struct Alchemist : SanguineModule {
 			case OUTPUT_POLYPHONIC_MIX:
 				bPolyOutConnected = e.connecting;
 				break;
+
+			case OUTPUT_LEFT:
+				bLeftOutConnected = e.connecting;
+				break;
+
+			case OUTPUT_RIGHT:
+				bRightOutConnected = e.connecting;
+				break;
 			}
 		}
 	}
 
+	static void setChannelBit(int& channels, const int channel, const bool bSet) {
+		channels = bSet ? channels | (1 << channel) : channels & ~(1 << channel);
+	}
+
 	json_t* dataToJson() override {
 		json_t* rootJ = SanguineModule::dataToJson();
 
@@ -712,13 +683,21 @@ struct Alchemist : SanguineModule {
 		json_t* soloedChannelsJ = json_array();
 
 		for (int channel = 0; channel < PORT_MAX_CHANNELS; ++channel) {
-			json_array_insert_new(mutedChannelsJ, channel, json_boolean(mutedChannels[channel]));
-			json_array_insert_new(soloedChannelsJ, channel, json_boolean(soloedChannels[channel]));
+			json_array_insert_new(mutedChannelsJ, channel,
+				json_boolean((muteSoloEngine.mutedChannels >> channel) & 1));
+			json_array_insert_new(soloedChannelsJ, channel,
+				json_boolean((muteSoloEngine.soloedChannels >> channel) & 1));
 		}
 
 		json_object_set_new(rootJ, "mutedChannels", mutedChannelsJ);
 		json_object_set_new(rootJ, "soloedChannels", soloedChannelsJ);
 
+		setJsonBoolean(rootJ, "widePanel", true);
+
+#ifndef METAMODULE
+		setJsonBoolean(rootJ, "chainFromLeft", bPendingChainFromLeft);
+#endif
+
 		return rootJ;
 	}
 
@@ -734,7 +713,7 @@ struct Alchemist : SanguineModule {
 					json_t* mutedJ = json_array_get(mutedChannelsJ, channel);
 
 					if (mutedJ) {
-						mutedChannels[channel] = json_boolean_value(mutedJ);
+						setChannelBit(muteSoloEngine.mutedChannels, channel, json_boolean_value(mutedJ));
 					}
 				}
 
@@ -742,11 +721,26 @@ struct Alchemist : SanguineModule {
 					json_t* soloedJ = json_array_get(soloedChannelsJ, channel);
 
 					if (soloedJ) {
-						soloedChannels[channel] = json_boolean_value(soloedJ);
+						setChannelBit(muteSoloEngine.soloedChannels, channel, json_boolean_value(soloedJ));
 					}
 				}
 			}
 		}
+
+		// Mutes apply from the first sample instead of the first lights turn.
+		muteSoloEngine.updateSoloCount();
+		activeChannels = muteSoloEngine.getActiveChannels();
+
+#ifndef METAMODULE
+		bool bWidePanel = false;
+		getJsonBoolean(rootJ, "widePanel", bWidePanel);
+		bMakeRoomForPanel = !bWidePanel;
+
+		if (getJsonBoolean(rootJ, "chainFromLeft", bPendingChainFromLeft)) {
+			bChainFromLeft = bPendingChainFromLeft;
+			updateLeftAlchemist();
+		}
+#endif
 	}
 };
 
@@ -755,7 +749,7 @@ struct AlchemistWidget : SanguineModuleWidget {
 		setModule(module);
 
 		moduleName = "alchemist";
-		panelSize = sanguineThemes::SIZE_23;
+		panelSize = sanguineThemes::SIZE_27;
 		backplateColor = sanguineThemes::PLATE_PURPLE;
 		bFaceplateSuffix = false;
 
@@ -766,7 +760,7 @@ struct AlchemistWidget : SanguineModuleWidget {
 #ifndef METAMODULE
 		addChild(createLightCentered<SmallLight<OrangeLight>>(millimetersToPixelsVec(2.6, 5.573), module,
 			Alchemist::LIGHT_EXPANDER_LEFT));
-		addChild(createLightCentered<SmallLight<OrangeLight>>(millimetersToPixelsVec(114.24, 5.573), module,
+		addChild(createLightCentered<SmallLight<OrangeLight>>(millimetersToPixelsVec(134.56, 5.573), module,
 			Alchemist::LIGHT_EXPANDER_RIGHT));
 #endif
 
@@ -796,6 +790,19 @@ struct AlchemistWidget : SanguineModuleWidget {
 			componentX += componentDeltaX;
 		}
 
+		static const float panBaseY = 19.5;
+		static const float panDeltaY = 11.f;
+
+		float panY = panBaseY;
+
+		for (int component = 0; component < 8; ++component) {
+			addParam(createParamCentered<Trimpot>(millimetersToPixelsVec(120.78, panY), module, Alchemist::PARAM_PAN + component));
+			addParam(createParamCentered<Trimpot>(millimetersToPixelsVec(130.58, panY), module,
+				Alchemist::PARAM_PAN + component + componentIdOffset));
+
+			panY += panDeltaY;
+		}
+
 #ifndef METAMODULE
 		SanguinePolyInputLight* inLight = new SanguinePolyInputLight(module, 7.876, 108.973);
 		addChild(inLight);
@@ -811,6 +818,12 @@ struct AlchemistWidget : SanguineModuleWidget {
 
 		SanguineMonoOutputLight* outMonoLight = new SanguineMonoOutputLight(module, 108.963, 108.973);
 		addChild(outMonoLight);
+
+		SanguineMonoOutputLight* outLeftLight = new SanguineMonoOutputLight(module, 120.78, 108.973);
+		addChild(outLeftLight);
+
+		SanguineMonoOutputLight* outRightLight = new SanguineMonoOutputLight(module, 130.58, 108.973);
+		addChild(outRightLight);
 #endif
 
 		addInput(createInputCentered<BananutPurple>(millimetersToPixelsVec(31.615, 114.094), module, Alchemist::INPUT_MASTER_MUTE));
@@ -833,6 +846,9 @@ struct AlchemistWidget : SanguineModuleWidget {
 
 		addOutput(createOutputCentered<BananutRedPoly>(millimetersToPixelsVec(95.442, 116.769), module, Alchemist::OUTPUT_POLYPHONIC_MIX));
 		addOutput(createOutputCentered<BananutRed>(millimetersToPixelsVec(108.963, 116.769), module, Alchemist::OUTPUT_MONO_MIX));
+
+		addOutput(createOutputCentered<BananutRed>(millimetersToPixelsVec(120.78, 116.769), module, Alchemist::OUTPUT_LEFT));
+		addOutput(createOutputCentered<BananutRed>(millimetersToPixelsVec(130.58, 116.769), module, Alchemist::OUTPUT_RIGHT));
 	}
 
 #ifndef METAMODULE
@@ -860,6 +876,24 @@ struct AlchemistWidget : SanguineModuleWidget {
 				alchemist->addExpander(modelAlembic, this);
 				}));
 		}
+
+		menu->addChild(new MenuSeparator());
+		menu->addChild(createCheckMenuItem("Chain mix from the Alchemist on the left", "",
+			[=]() {return alchemist->bPendingChainFromLeft; },
+			[=]() {alchemist->requestChainFromLeft(!alchemist->bPendingChainFromLeft); }));
+	}
+
+	/* Patches saved with the 23 HP panel have their neighbours against its old edge: they're pushed right, so
+	   nothing overlaps and an Alembic on the right stays attached. */
+	void step() override {
+		Alchemist* alchemist = dynamic_cast<Alchemist*>(this->module);
+
+		if (alchemist && alchemist->bMakeRoomForPanel) {
+			alchemist->bMakeRoomForPanel = false;
+			APP->scene->rack->setModulePosForce(this, box.pos);
+		}
+
+		SanguineModuleWidget::step();
 	}
 #endif
 };
@@ -2,4 +2,58 @@
 
 using namespace sanguineCommonCode;
 
-const float SaturatorFloat::limit = 12.f;
\ No newline at end of file
+using simd::float_4;
+
+const float SaturatorFloat::limit = 12.f;
+
+namespace alchemist {
+    // Seconds for a channel to fade fully in or out when muted, soloed or master muted.
+    static const float kGainRampDuration = 0.004f;
+
+    static const int kPanTableSize = 64;
+
+    // Alchemist to the Alchemist on its right: the chain's sums so far, with the master mix applied.
+    struct BusMessage {
+        float monoMix = 0.f;
+        float leftMix = 0.f;
+        float rightMix = 0.f;
+    };
+
+    // Constant power pan law, linearly interpolated between kPanTableSize + 1 points from hard left to hard right.
+    struct PanTable {
+        float leftGains[kPanTableSize + 1];
+
+        PanTable() {
+            for (int point = 0; point <= kPanTableSize; ++point) {
+                leftGains[point] = std::cos(point * static_cast<float>(M_PI_2) / kPanTableSize);
+            }
+        }
+
+        // Pan goes from -1 (left) to 1 (right); the right gain reads the table backwards.
+        void getGains(const float pan, float& leftGain, float& rightGain) const {
+            const float position = (pan + 1.f) * 0.5f * kPanTableSize;
+            const int point = std::min(static_cast<int>(position), kPanTableSize - 1);
+            const float fraction = position - point;
+            const int mirroredPoint = kPanTableSize - point;
+
+            leftGain = leftGains[point] + (leftGains[point + 1] - leftGains[point]) * fraction;
+            rightGain = leftGains[mirroredPoint] + (leftGains[mirroredPoint - 1] - leftGains[mirroredPoint]) * fraction;
+        }
+    };
+
+    /* Mute and solo gains for 16 channels, four at a time.
+       Each sample, a channel's gain moves by up to step towards 1 if its bit is set in the target mask and towards 0
+       otherwise; the cost is the same whether no channel or every channel is ramping. */
+    struct GainRamps {
+        float_4 gains[4] = {};
+
+        void process(const int targetChannels, const float step) {
+            for (int block = 0; block < 4; ++block) {
+                const int targetBits = targetChannels >> (block * 4);
+                const float_4 targets = float_4(targetBits & 1, (targetBits >> 1) & 1, (targetBits >> 2) & 1,
+                    (targetBits >> 3) & 1);
+                gains[block] += simd::clamp(targets - gains[block], -step, step);
+            }
+        }
+    };
+}
@@ -1,4 +1,5 @@
 #include "alembic.hpp"
+#include "sanguinejson.hpp"
 
 Alembic::Alembic() {
 	config(PARAMS_COUNT, INPUTS_COUNT, OUTPUTS_COUNT, LIGHTS_COUNT);
@@ -6,8 +7,35 @@ Alembic::Alembic() {
 	for (int channel = 0; channel < PORT_MAX_CHANNELS; ++channel) {
 		int channelNumber = channel + 1;
 		configInput(INPUT_GAIN_CV + channel, string::f("Channel %d gain CV", channelNumber));
+		configInput(INPUT_PAN_CV + channel, string::f("Channel %d pan CV", channelNumber));
 		configOutput(OUTPUT_CHANNEL + channel, string::f("Channel %d", channelNumber));
 	}
+
+	leftExpander.producerMessage = &outputsMessages[0];
+	leftExpander.consumerMessage = &outputsMessages[1];
+}
+
+void Alembic::process(const ProcessArgs& args) {
+	Module* alchemistMaster = getLeftExpander().module;
+
+	if (alchemistMaster && alchemistMaster->getModel() == modelAlchemist && !alchemistMaster->isBypassed()) {
+		const alembic::OutputsMessage* outputsMessage =
+			static_cast<alembic::OutputsMessage*>(leftExpander.consumerMessage);
+
+		alembic::ControlsMessage* controlsMessage =
+			static_cast<alembic::ControlsMessage*>(alchemistMaster->rightExpander.producerMessage);
+
+		for (int channel = 0; channel < PORT_MAX_CHANNELS; ++channel) {
+			if (outputsConnected[channel]) {
+				outputs[OUTPUT_CHANNEL + channel].setVoltage(outputsMessage->outputVoltages[channel]);
+			}
+
+			controlsMessage->gainVoltages[channel] = inputs[INPUT_GAIN_CV + channel].getVoltage();
+			controlsMessage->panVoltages[channel] = inputs[INPUT_PAN_CV + channel].getVoltage();
+		}
+
+		alchemistMaster->rightExpander.requestMessageFlip();
+	}
 }
 
 void Alembic::onExpanderChange(const ExpanderChangeEvent& e) {
@@ -38,12 +66,28 @@ void Alembic::onPortChange(const PortChangeEvent& e) {
 	}
 }
 
+json_t* Alembic::dataToJson() {
+	json_t* rootJ = SanguineModule::dataToJson();
+
+	setJsonBoolean(rootJ, "widePanel", true);
+
+	return rootJ;
+}
+
+void Alembic::dataFromJson(json_t* rootJ) {
+	SanguineModule::dataFromJson(rootJ);
+
+	bool bWidePanel = false;
+	getJsonBoolean(rootJ, "widePanel", bWidePanel);
+	bMakeRoomForPanel = !bWidePanel;
+}
+
 struct AlembicWidget : SanguineModuleWidget {
 	explicit AlembicWidget(Alembic* module) {
 		setModule(module);
 
 		moduleName = "alembic";
-		panelSize = sanguineThemes::SIZE_10;
+		panelSize = sanguineThemes::SIZE_14;
 		backplateColor = sanguineThemes::PLATE_PURPLE;
 		bFaceplateSuffix = false;
 
@@ -56,13 +100,13 @@ struct AlembicWidget : SanguineModuleWidget {
 		SanguineMonoOutputLight* outMonoLight1 = new SanguineMonoOutputLight(module, 6.466, 17.494);
 		addChild(outMonoLight1);
 
-		SanguineMonoOutputLight* outMonoLight2 = new SanguineMonoOutputLight(module, 31.404, 17.494);
+		SanguineMonoOutputLight* outMonoLight2 = new SanguineMonoOutputLight(module, 40.924, 17.494);
 		addChild(outMonoLight2);
 
 		SanguineStaticRGBLight* cvLight1 = new SanguineStaticRGBLight(module, "res/light_cv_lit.svg", 19.397, 17.494, true, kSanguineYellowLight);
 		addChild(cvLight1);
 
-		SanguineStaticRGBLight* cvLight2 = new SanguineStaticRGBLight(module, "res/light_cv_lit.svg", 44.334, 17.494, true, kSanguineYellowLight);
+		SanguineStaticRGBLight* cvLight2 = new SanguineStaticRGBLight(module, "res/light_cv_lit.svg", 53.854, 17.494, true, kSanguineYellowLight);
 		addChild(cvLight2);
 
 		static const int offset = 8;
@@ -74,14 +118,29 @@ struct AlembicWidget : SanguineModuleWidget {
 
 		for (int component = 0; component < 8; ++component) {
 			addOutput(createOutputCentered<BananutRed>(millimetersToPixelsVec(6.466, currentPortY), module, Alembic::OUTPUT_CHANNEL + component));
-			addOutput(createOutputCentered<BananutRed>(millimetersToPixelsVec(31.403, currentPortY), module, Alembic::OUTPUT_CHANNEL + component + offset));
+			addOutput(createOutputCentered<BananutRed>(millimetersToPixelsVec(40.923, currentPortY), module, Alembic::OUTPUT_CHANNEL + component + offset));
 
 			addInput(createInputCentered<BananutPurple>(millimetersToPixelsVec(19.397, currentPortY), module, Alembic::INPUT_GAIN_CV + component));
-			addInput(createInputCentered<BananutPurple>(millimetersToPixelsVec(44.334, currentPortY), module, Alembic::INPUT_GAIN_CV + component + offset));
+			addInput(createInputCentered<BananutPurple>(millimetersToPixelsVec(53.854, currentPortY), module, Alembic::INPUT_GAIN_CV + component + offset));
+
+			addInput(createInputCentered<BananutBlack>(millimetersToPixelsVec(30.197, currentPortY), module, Alembic::INPUT_PAN_CV + component));
+			addInput(createInputCentered<BananutBlack>(millimetersToPixelsVec(64.654, currentPortY), module, Alembic::INPUT_PAN_CV + component + offset));
 
 			currentPortY += deltaY;
 		}
 	}
+
+	// Patches saved with the 10 HP panel have their neighbours against its old edge: they're pushed right.
+	void step() override {
+		Alembic* alembic = dynamic_cast<Alembic*>(this->module);
+
+		if (alembic && alembic->bMakeRoomForPanel) {
+			alembic->bMakeRoomForPanel = false;
+			APP->scene->rack->setModulePosForce(this, box.pos);
+		}
+
+		SanguineModuleWidget::step();
+	}
 };
 
 Model* modelAlembic = createModel<Alembic, AlembicWidget>("Sanguine-Alembic");
\ No newline at end of file
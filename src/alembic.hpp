@@ -6,6 +6,19 @@
 
 using namespace sanguineCommonCode;
 
+namespace alembic {
+	// Alembic to Alchemist.
+	struct ControlsMessage {
+		float gainVoltages[PORT_MAX_CHANNELS] = {};
+		float panVoltages[PORT_MAX_CHANNELS] = {};
+	};
+
+	// Alchemist to Alembic.
+	struct OutputsMessage {
+		float outputVoltages[PORT_MAX_CHANNELS] = {};
+	};
+}
+
 struct Alembic : SanguineModule {
 	enum ParamIds {
 		PARAMS_COUNT
@@ -13,6 +26,7 @@ struct Alembic : SanguineModule {
 
 	enum InputIds {
 		ENUMS(INPUT_GAIN_CV, PORT_MAX_CHANNELS),
+		ENUMS(INPUT_PAN_CV, PORT_MAX_CHANNELS),
 		INPUTS_COUNT
 	};
 
@@ -28,9 +42,14 @@ struct Alembic : SanguineModule {
 
 	Alembic();
 
+	void process(const ProcessArgs& args) override;
+
 	void onExpanderChange(const ExpanderChangeEvent& e) override;
 	void onPortChange(const PortChangeEvent& e) override;
 
+	json_t* dataToJson() override;
+	void dataFromJson(json_t* rootJ) override;
+
 	inline bool getOutputConnected(const int channel) const {
 		return outputsConnected[channel];
 	}
@@ -45,8 +64,13 @@ struct Alembic : SanguineModule {
 		inputsConnected[channel] = value;
 	}
 
+	// Set when a patch from before the 14 HP panel loads; the widget then pushes its right neighbours away.
+	bool bMakeRoomForPanel = false;
+
 private:
 	bool bHadMaster = false;
 	bool outputsConnected[PORT_MAX_CHANNELS] = {};
-	bool inputsConnected[PORT_MAX_CHANNELS] = {};
+	bool inputsConnected[INPUTS_COUNT] = {};
+
+	alembic::OutputsMessage outputsMessages[2];
 };
\ No newline at end of file
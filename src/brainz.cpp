@@ -7,6 +7,7 @@
 #include "sanguinejson.hpp"
 
 #include <chrono>
+#include "displaysnapshot.hpp"
 #include "brainz.hpp"
 
 using namespace sanguineCommonCode;
@@ -150,6 +151,17 @@ struct Brainz : SanguineModule {
 	dsp::PulseGenerator pgOutTriggers[kMaxOutTriggers];
 
 	dsp::ClockDivider clockDivider;
+	dsp::ClockDivider displayDivider;
+
+	struct DisplaySnapshot {
+		int currentCounters[kMaxSteps];
+		int maxCounters[kMaxSteps];
+		int metronomeSpeed;
+		int metronomeSteps;
+		int metronomeStepsDone;
+	};
+
+	displaySnapshots::TripleBuffer<DisplaySnapshot> displayBuffer;
 
 	Brainz() {
 		config(PARAMS_COUNT, INPUTS_COUNT, OUTPUTS_COUNT, LIGHTS_COUNT);
@@ -210,6 +222,9 @@ struct Brainz : SanguineModule {
 		onReset();
 
 		clockDivider.setDivision(kClockDivider);
+		displayDivider.setDivision(kClockDivider);
+
+		publishDisplaySnapshot();
 	}
 
 	void process(const ProcessArgs& args) override {
@@ -605,6 +620,25 @@ struct Brainz : SanguineModule {
 				outputs[OUTPUT_RESET].setVoltage(bResetSent ? 10.f : 0.f);
 			}
 		}
+
+		// Counters change in both branches, so displays are published on their own divider.
+		if (displayDivider.process()) {
+			publishDisplaySnapshot();
+		}
+	}
+
+	void publishDisplaySnapshot() {
+		DisplaySnapshot& snapshot = displayBuffer.getWriteBuffer();
+
+		for (int step = 0; step < kMaxSteps; ++step) {
+			snapshot.currentCounters[step] = currentCounters[step];
+			snapshot.maxCounters[step] = maxCounters[step];
+		}
+		snapshot.metronomeSpeed = metronomeSpeed;
+		snapshot.metronomeSteps = metronomeSteps;
+		snapshot.metronomeStepsDone = metronomeStepsDone;
+
+		displayBuffer.publish();
 	}
 
 	void onReset() override {
@@ -900,6 +934,8 @@ struct BlueQuarterNoteLight : SanguineStaticRGBLight {
 #endif
 
 struct BrainzWidget : SanguineModuleWidget {
+	Brainz::DisplaySnapshot displaySnapshot = {};
+
 	explicit BrainzWidget(Brainz* module) {
 		setModule(module);
 
@@ -1154,17 +1190,27 @@ struct BrainzWidget : SanguineModuleWidget {
 #endif
 
 		if (module) {
-			displayStepsACurrent->values.numberValue = &module->currentCounters[0];
-			displayStepsATotal->values.numberValue = &module->maxCounters[0];
-			displayStepsBCurrent->values.numberValue = &module->currentCounters[1];
-			displayStepsBTotal->values.numberValue = &module->maxCounters[1];
-			displayStepsCCurrent->values.numberValue = &module->currentCounters[2];
-			displayStepsCTotal->values.numberValue = &module->maxCounters[2];
-			displayMetronomeSpeed->values.numberValue = &module->metronomeSpeed;
-			displayMetronomeCurrentStep->values.numberValue = &module->metronomeStepsDone;
-
-			displayMetronomeTotalSteps->values.numberValue = &module->metronomeSteps;
+			displayStepsACurrent->values.numberValue = &displaySnapshot.currentCounters[0];
+			displayStepsATotal->values.numberValue = &displaySnapshot.maxCounters[0];
+			displayStepsBCurrent->values.numberValue = &displaySnapshot.currentCounters[1];
+			displayStepsBTotal->values.numberValue = &displaySnapshot.maxCounters[1];
+			displayStepsCCurrent->values.numberValue = &displaySnapshot.currentCounters[2];
+			displayStepsCTotal->values.numberValue = &displaySnapshot.maxCounters[2];
+			displayMetronomeSpeed->values.numberValue = &displaySnapshot.metronomeSpeed;
+			displayMetronomeCurrentStep->values.numberValue = &displaySnapshot.metronomeStepsDone;
+
+			displayMetronomeTotalSteps->values.numberValue = &displaySnapshot.metronomeSteps;
+		}
+	}
+
+	void step() override {
+		Brainz* brainzModule = dynamic_cast<Brainz*>(this->module);
+
+		if (brainzModule && brainzModule->displayBuffer.consume()) {
+			displaySnapshot = brainzModule->displayBuffer.getReadBuffer();
 		}
+
+		SanguineModuleWidget::step();
 	}
 };
 
@@ -3,10 +3,14 @@
 #include "sanguinehelpers.hpp"
 #include "sanguinerandom.hpp"
 
+#include "kerneltable.hpp"
+
 #include "bukavac.hpp"
 
 using namespace sanguineCommonCode;
 
+using simd::float_4;
+
 struct Bukavac : SanguineModule {
 	enum ParamIds {
 		PARAM_PERLIN_SPEED,
@@ -73,17 +77,56 @@ struct Bukavac : SanguineModule {
 	static constexpr float kRedFilterB[] = { 0.00425611, 0.00425611 };
 	static constexpr float kRedFilterA[] = { -0.99148778 };
 
-	bool bHaveWhiteCable = false;
-	bool bHaveRedCable = false;
-	bool bHaveVioletCable = false;
-	bool bHaveGrayCable = false;
-	bool bHavePinkCable = false;
-	bool bHaveBlueCable = false;
+	enum WhiteConnectionBits {
+		CONNECTION_WHITE = 1 << 0,
+		CONNECTION_RED = 1 << 1,
+		CONNECTION_VIOLET = 1 << 2,
+		CONNECTION_GRAY = 1 << 3,
+		WHITE_CONNECTIONS_COUNT = 1 << 4
+	};
+
+	enum PinkConnectionBits {
+		CONNECTION_PINK = 1 << 0,
+		CONNECTION_BLUE = 1 << 1,
+		PINK_CONNECTIONS_COUNT = 1 << 2
+	};
+
+	enum PerlinConnectionBits {
+		CONNECTION_PERLIN_MIX = 1 << 0,
+		CONNECTION_PERLIN_SPEED = 1 << 1,
+		CONNECTION_PERLIN_AMP = 1 << 2,
+		PERLIN_CONNECTIONS_COUNT = 1 << 3
+	};
+
+	typedef void (Bukavac::* NoiseKernel)(const ProcessArgs& args);
+
+	// Each noise family gets a branch free kernel for every combination of its connected ports.
+	template <int ConnectionMask>
+	struct WhiteKernel {
+		static NoiseKernel kernel() { return &Bukavac::processWhiteNoises<ConnectionMask>; }
+	};
+
+	template <int ConnectionMask>
+	struct PinkKernel {
+		static NoiseKernel kernel() { return &Bukavac::processPinkNoises<ConnectionMask>; }
+	};
+
+	template <int ConnectionMask>
+	struct PerlinKernel {
+		static NoiseKernel kernel() { return &Bukavac::processPerlinNoise<ConnectionMask>; }
+	};
+
+	int whiteConnections = 0;
+	int pinkConnections = 0;
+	int perlinConnections = 0;
+
+	NoiseKernel whiteKernel = &Bukavac::processWhiteNoises<0>;
+	NoiseKernel pinkKernel = &Bukavac::processPinkNoises<0>;
+	NoiseKernel perlinKernel = &Bukavac::processPerlinNoise<0>;
+
 	bool bHavePrismCable = false;
-	bool bHavePerlinMixCable = false;
+	bool bHavePerlinCables = false;
 	bool perlinOctaveCables[kPerlinOctaves] = {};
-	bool bHavePerlinSpeedCable = false;
-	bool bHavePerlinAmpCable = false;
 
 	pcg32 pcgRng;
 	sanguineRandom::SanguineRandomNormalCustom rngNormal;
@@ -139,7 +182,33 @@ struct Bukavac : SanguineModule {
 	}
 
 	void process(const ProcessArgs& args) override {
-		if (bHaveWhiteCable || bHaveRedCable || bHaveVioletCable || bHaveGrayCable) {
+		(this->*whiteKernel)(args);
+
+		(this->*pinkKernel)(args);
+
+		// Prism noise: uniform noise
+		/*
+		   Note: Black noise was the original definition, made up by VCV.
+		   Amended by me to be Prism(for light ring convenience)... also completely made up.
+		*/
+		if (bHavePrismCable) {
+			float uniformNoise = ldexpf(pcgRng(), -32);
+			outputs[OUTPUT_PRISM].setVoltage(uniformNoise * 10.f - 5.f);
+		}
+
+		if (bHavePerlinCables) {
+			(this->*perlinKernel)(args);
+		}
+	}
+
+	template <int ConnectionMask>
+	void processWhiteNoises(const ProcessArgs& args) {
+		const bool bHaveWhiteCable = ConnectionMask & CONNECTION_WHITE;
+		const bool bHaveRedCable = ConnectionMask & CONNECTION_RED;
+		const bool bHaveVioletCable = ConnectionMask & CONNECTION_VIOLET;
+		const bool bHaveGrayCable = ConnectionMask & CONNECTION_GRAY;
+
+		if (ConnectionMask != 0) {
 			// White noise: equal power density
 			float white = rngNormal.normal(pcgRng);
 			if (bHaveWhiteCable) {
@@ -165,8 +234,14 @@ struct Bukavac : SanguineModule {
 				outputs[OUTPUT_GRAY].setVoltage(gray * kGain);
 			}
 		}
+	}
 
-		if (bHavePinkCable || bHaveBlueCable) {
+	template <int ConnectionMask>
+	void processPinkNoises(const ProcessArgs& args) {
+		const bool bHavePinkCable = ConnectionMask & CONNECTION_PINK;
+		const bool bHaveBlueCable = ConnectionMask & CONNECTION_BLUE;
+
+		if (ConnectionMask != 0) {
 			// Pink noise: -3dB/oct
 			float pink = pinkNoiseGenerator.process() / 0.816f;
 			if (bHavePinkCable) {
@@ -180,77 +255,78 @@ struct Bukavac : SanguineModule {
 				outputs[OUTPUT_BLUE].setVoltage(blue * kGain);
 			}
 		}
+	}
 
-		// Prism noise: uniform noise
-		/*
-		   Note: Black noise was the original definition, made up by VCV.
-		   Amended by me to be Prism(for light ring convenience)... also completely made up.
-		*/
-		if (bHavePrismCable) {
-			float uniformNoise = ldexpf(pcgRng(), -32);
-			outputs[OUTPUT_PRISM].setVoltage(uniformNoise * 10.f - 5.f);
-		}
+	template <int ConnectionMask>
+	void processPerlinNoise(const ProcessArgs& args) {
+		const bool bHavePerlinMixCable = ConnectionMask & CONNECTION_PERLIN_MIX;
+		const bool bHavePerlinSpeedCable = ConnectionMask & CONNECTION_PERLIN_SPEED;
+		const bool bHavePerlinAmpCable = ConnectionMask & CONNECTION_PERLIN_AMP;
 
-		if (bHavePerlinMixCable || perlinOctaveCables[0] || perlinOctaveCables[1] ||
-			perlinOctaveCables[2] || perlinOctaveCables[3]) {
-			if (currentPerlinTime > kMaxTime) {
-				currentPerlinTime = 0;
-			}
+		if (currentPerlinTime > kMaxTime) {
+			currentPerlinTime = 0;
+		}
 
-			currentPerlinTime += args.sampleTime;
+		currentPerlinTime += args.sampleTime;
 
-			float perlinSpeed = params[PARAM_PERLIN_SPEED].getValue();
-			if (bHavePerlinSpeedCable) {
-				float perlinSpeedVoltage = inputs[INPUT_PERLIN_SPEED].getVoltage() / 5.f;
-				float perlinSpeedVoltagePercent = params[PARAM_PERLIN_SPEED_CV].getValue();
-				perlinSpeed = getPerlinEffectiveValue(perlinSpeedVoltage, perlinSpeed, perlinSpeedVoltagePercent, 1.f, 500.f);
-			}
+		float perlinSpeed = params[PARAM_PERLIN_SPEED].getValue();
+		if (bHavePerlinSpeedCable) {
+			float perlinSpeedVoltage = inputs[INPUT_PERLIN_SPEED].getVoltage() / 5.f;
+			float perlinSpeedVoltagePercent = params[PARAM_PERLIN_SPEED_CV].getValue();
+			perlinSpeed = getPerlinEffectiveValue(perlinSpeedVoltage, perlinSpeed, perlinSpeedVoltagePercent, 1.f, 500.f);
+		}
 
-			float perlinAmplifier = params[PARAM_PERLIN_AMP].getValue();
-			if (bHavePerlinAmpCable) {
-				float perlinAmplifierVoltage = inputs[INPUT_PERLIN_AMP].getVoltage() / 5.f;
-				float perlinAmplifierVoltagePercent = params[PARAM_PERLIN_AMP_CV].getValue();
-				perlinAmplifier = getPerlinEffectiveValue(perlinAmplifierVoltage, perlinAmplifier, perlinAmplifierVoltagePercent, 1.f, 13.f);
-			}
+		float perlinAmplifier = params[PARAM_PERLIN_AMP].getValue();
+		if (bHavePerlinAmpCable) {
+			float perlinAmplifierVoltage = inputs[INPUT_PERLIN_AMP].getVoltage() / 5.f;
+			float perlinAmplifierVoltagePercent = params[PARAM_PERLIN_AMP_CV].getValue();
+			perlinAmplifier = getPerlinEffectiveValue(perlinAmplifierVoltage, perlinAmplifier, perlinAmplifierVoltagePercent, 1.f, 13.f);
+		}
 
-			float octaveMult = 1.0;
-			for (int octave = 0; octave < kPerlinOctaves; ++octave) {
-				noise[octave] = perlinAmplifier * getPerlinNoise(currentPerlinTime * perlinSpeed * octaveMult);
-				if (perlinOctaveCables[octave]) {
-					outputs[OUTPUT_PERLIN_NOISE0 + octave].setVoltage(noise[octave]);
-				}
-				octaveMult *= 2;
+		// One lane per octave.
+		const float_4 octaveMultipliers = { 1.f, 2.f, 4.f, 8.f };
+		const float_4 octaveNoise = perlinAmplifier * getPerlinNoise(currentPerlinTime * perlinSpeed * octaveMultipliers);
+		for (int octave = 0; octave < kPerlinOctaves; ++octave) {
+			noise[octave] = octaveNoise[octave];
+			if (perlinOctaveCables[octave]) {
+				outputs[OUTPUT_PERLIN_NOISE0 + octave].setVoltage(noise[octave]);
 			}
+		}
 
-			if (bHavePerlinMixCable) {
-				mixPerlinOctaves(noise);
-			}
+		if (bHavePerlinMixCable) {
+			mixPerlinOctaves(noise);
 		}
 	}
 
-	float makePerlinGradient(int hash, float x) {
+	float getPerlinGradient(int hash) {
 		int hashBitmask = hash & 15;
 		float gradient = 1.0 + (hashBitmask & 7);
 		if (hashBitmask & 8) {
 			gradient = -gradient;
 		}
-		return (gradient * x);
+		return gradient;
 	}
 
-	float getPerlinNoise(float x) {
-		int i0 = FASTFLOOR(x);
-		int i1 = i0 + 1;
-		float x0 = x - i0;
-		float x1 = x0 - 1.0;
-		float t1 = 1.0 - x1 * x1;
-		float n0;
-		float n1;
-		float t0 = 1.0 - x0 * x0;
+	/* Four octaves at once: only the gradient lookups are per lane, the smoothing is done for all of them in one pass.
+	   Positions are never negative, so truncating them floors them. */
+	float_4 getPerlinNoise(const float_4 x) {
+		const float_4 cells = simd::trunc(x);
+		const float_4 x0 = x - cells;
+		const float_4 x1 = x0 - 1.f;
+
+		float_4 gradients0;
+		float_4 gradients1;
+		for (int lane = 0; lane < kPerlinOctaves; ++lane) {
+			int i0 = static_cast<int>(cells[lane]);
+			gradients0[lane] = getPerlinGradient(bukavac::permutations[i0 & 0xff]);
+			gradients1[lane] = getPerlinGradient(bukavac::permutations[(i0 + 1) & 0xff]);
+		}
+
+		float_4 t0 = 1.f - x0 * x0;
 		t0 *= t0;
-		n0 = t0 * t0 * makePerlinGradient(bukavac::permutations[i0 & 0xff], x0);
+		float_4 t1 = 1.f - x1 * x1;
 		t1 *= t1;
-		n1 = t1 * t1 * makePerlinGradient(bukavac::permutations[i1 & 0xff], x1);
-		return (0.25f * (n0 + n1));
+		return 0.25f * (t0 * t0 * (gradients0 * x0) + t1 * t1 * (gradients1 * x1));
 	}
 
 	void mixPerlinOctaves(float* noise) {
@@ -273,32 +349,53 @@ struct Bukavac : SanguineModule {
 		return clamp(baseValue + ((inputVoltage * maxValue) * attenuverterValue), minvalue, maxValue);
 	}
 
+	void setConnection(int& connections, const int connection, const bool connected) {
+		if (connected) {
+			connections |= connection;
+		} else {
+			connections &= ~connection;
+		}
+	}
+
+	void updateKernels() {
+		static const kernelTables::KernelTable<NoiseKernel, WHITE_CONNECTIONS_COUNT, WhiteKernel> whiteKernels;
+		static const kernelTables::KernelTable<NoiseKernel, PINK_CONNECTIONS_COUNT, PinkKernel> pinkKernels;
+		static const kernelTables::KernelTable<NoiseKernel, PERLIN_CONNECTIONS_COUNT, PerlinKernel> perlinKernels;
+
+		whiteKernel = whiteKernels.kernels[whiteConnections];
+		pinkKernel = pinkKernels.kernels[pinkConnections];
+		perlinKernel = perlinKernels.kernels[perlinConnections];
+
+		bHavePerlinCables = (perlinConnections & CONNECTION_PERLIN_MIX) || perlinOctaveCables[0] ||
+			perlinOctaveCables[1] || perlinOctaveCables[2] || perlinOctaveCables[3];
+	}
+
 	void onPortChange(const PortChangeEvent& e) override {
 		switch (e.type) {
 		case Port::OUTPUT:
 			switch (e.portId) {
 			case OUTPUT_WHITE:
-				bHaveWhiteCable = e.connecting;
+				setConnection(whiteConnections, CONNECTION_WHITE, e.connecting);
 				break;
 
 			case OUTPUT_RED:
-				bHaveRedCable = e.connecting;
+				setConnection(whiteConnections, CONNECTION_RED, e.connecting);
 				break;
 
 			case OUTPUT_VIOLET:
-				bHaveVioletCable = e.connecting;
+				setConnection(whiteConnections, CONNECTION_VIOLET, e.connecting);
 				break;
 
 			case OUTPUT_GRAY:
-				bHaveGrayCable = e.connecting;
+				setConnection(whiteConnections, CONNECTION_GRAY, e.connecting);
 				break;
 
 			case OUTPUT_PINK:
-				bHavePinkCable = e.connecting;
+				setConnection(pinkConnections, CONNECTION_PINK, e.connecting);
 				break;
 
 			case OUTPUT_BLUE:
-				bHaveBlueCable = e.connecting;
+				setConnection(pinkConnections, CONNECTION_BLUE, e.connecting);
 				break;
 
 			case OUTPUT_PRISM:
@@ -306,7 +403,7 @@ struct Bukavac : SanguineModule {
 				break;
 
 			case OUTPUT_PERLIN_NOISE_MIX:
-				bHavePerlinMixCable = e.connecting;
+				setConnection(perlinConnections, CONNECTION_PERLIN_MIX, e.connecting);
 				break;
 
 			case OUTPUT_PERLIN_NOISE0:
@@ -330,15 +427,17 @@ struct Bukavac : SanguineModule {
 		case Port::INPUT:
 			switch (e.portId) {
 			case INPUT_PERLIN_SPEED:
-				bHavePerlinSpeedCable = e.connecting;
+				setConnection(perlinConnections, CONNECTION_PERLIN_SPEED, e.connecting);
 				break;
 
 			case INPUT_PERLIN_AMP:
-				bHavePerlinAmpCable = e.connecting;
+				setConnection(perlinConnections, CONNECTION_PERLIN_AMP, e.connecting);
 				break;
 			}
 			break;
 		}
+
+		updateKernels();
 	}
 };
 
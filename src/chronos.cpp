@@ -7,8 +7,14 @@
 #include "seqcomponents.hpp"
 #endif
 
+#include "kerneltable.hpp"
+#include "phasesine.hpp"
+#include "triggerbank.hpp"
+
 #include "chronos.hpp"
 
+#include <atomic>
+
 using simd::float_4;
 
 struct Chronos : SanguineModule {
@@ -105,24 +111,62 @@ struct Chronos : SanguineModule {
     size_t ledsChannel[chronos::kMaxSections] = {};
 
     float clockFrequencies[chronos::kMaxSections] = {};
-    static constexpr float doublePi = 2.f * M_PI;
+    int clockRatios[chronos::kMaxSections] = {
+        chronos::kDefaultClockRatio,
+        chronos::kDefaultClockRatio,
+        chronos::kDefaultClockRatio,
+        chronos::kDefaultClockRatio
+    };
 
-    float_4 phases[chronos::kMaxSections][4];
+    chronos::PhaseAccumulator4 phaseAccumulators[chronos::kMaxSections][4];
     float_4 sineVoltages[chronos::kMaxSections][4];
+    float_4 phaseIncrements[chronos::kMaxSections][4] = {};
+    chronos::CvRateRamp4 cvRateRamps[chronos::kMaxSections][4][chronos::WAVEFORMS_COUNT];
 
     dsp::ClockDivider lightsDivider;
-    dsp::Timer clockTimers[chronos::kMaxSections];
-    dsp::TSchmittTrigger<float_4> stResetTriggers[chronos::kMaxSections][4];
-    dsp::SchmittTrigger stClockTriggers[chronos::kMaxSections];
+    dsp::ClockDivider cvRateDivider;
+    chronos::ClockFollower clockFollowers[chronos::kMaxSections];
+    triggerBanks::SchmittTriggerBank<> stResetTriggers[chronos::kMaxSections];
+    // One lane per section.
+    triggerBanks::SchmittTriggerBank<chronos::kMaxSections> stClockTriggers;
 
     bool clocksConnected[chronos::kMaxSections] = {};
     bool sinesConnected[chronos::kMaxSections] = {};
     bool trianglesConnected[chronos::kMaxSections] = {};
     bool sawsConnected[chronos::kMaxSections] = {};
     bool squaresConnected[chronos::kMaxSections] = {};
-    bool resetsConnected[chronos::kMaxSections] = {};
-    bool fmsConnected[chronos::kMaxSections] = {};
-    bool pwmsConnected[chronos::kMaxSections] = {};
+
+    bool cvRates[chronos::kMaxSections] = {};
+    bool bHaveCvRateSections = false;
+    // Set from the UI thread, applied in process() so a section doesn't change rate while it runs.
+    bool pendingCvRates[chronos::kMaxSections] = {};
+    std::atomic<bool> bHavePendingCvRates{ false };
+
+    /* Only the outputs decide how much work a channel takes, so only they key the kernels.
+       Unpatched reset, FM and PWM inputs read 0 V, which leaves phases, pitch and pulse width as they are. */
+    enum ConnectionBits {
+        CONNECTION_SINE = 1 << 0,
+        CONNECTION_TRIANGLE = 1 << 1,
+        CONNECTION_SAW = 1 << 2,
+        CONNECTION_SQUARE = 1 << 3,
+        CONNECTIONS_COUNT = 1 << 4
+    };
+
+    typedef void (Chronos::* SectionKernel)(const int section, const ProcessArgs& args,
+        const bool bIsLightsTurn, const bool bIsCvRateTurn, const float sampleTime);
+
+    // Sections run a kernel specialized on their connected ports, so the channel loop doesn't branch on them.
+    template <int ConnectionMask>
+    struct ConnectedKernel {
+        static SectionKernel kernel() { return &Chronos::processSection<ConnectionMask>; }
+    };
+
+    SectionKernel sectionKernels[chronos::kMaxSections] = {
+        &Chronos::processSection<0>,
+        &Chronos::processSection<0>,
+        &Chronos::processSection<0>,
+        &Chronos::processSection<0>
+    };
 
     struct FrequencyQuantity : ParamQuantity {
         float getDisplayValue() override {
@@ -198,171 +242,349 @@ struct Chronos : SanguineModule {
             configOutput(OUTPUT_TRIANGLE_1 + section, string::f("LFO %d triangle", lfoNumber));
             configOutput(OUTPUT_SAW_1 + section, string::f("LFO %d sawtooth", lfoNumber));
             configOutput(OUTPUT_SQUARE_1 + section, string::f("LFO %d square", lfoNumber));
+
+            stResetTriggers[section].setThresholds(0.1f, 2.f);
         }
 
+        stClockTriggers.setThresholds(0.1f, 2.f);
+
         init();
         lightsDivider.setDivision(kLightsFrequency);
+        cvRateDivider.setDivision(chronos::kCvRateDivision);
     };
 
     void process(const ProcessArgs& args) override {
+        if (bHavePendingCvRates.exchange(false, std::memory_order_acquire)) {
+            applyCvRates();
+        }
+
         bool bIsLightsTurn = lightsDivider.process();
+        // kLightsFrequency is a multiple of kCvRateDivision: every lights turn is a CV rate turn too.
+        bool bIsCvRateTurn = cvRateDivider.process();
 
         float sampleTime = 0.f;
         if (bIsLightsTurn) {
             sampleTime = args.sampleTime * kLightsFrequency;
         }
 
+        // Clocks
+        float_4 clockVoltages;
         for (int section = 0; section < chronos::kMaxSections; ++section) {
-            float paramFrequency = params[PARAM_FREQUENCY_1 + section].getValue();
-            float paramFm = params[PARAM_FM_1 + section].getValue();
-            float paramPulsewidth = params[PARAM_PULSEWIDTH_1 + section].getValue();
-            float paramPwm = params[PARAM_PWM_1 + section].getValue();
-            bool bHasOffset = !(static_cast<bool>(params[PARAM_BIPOLAR_1 + section].getValue()));
-            bool bIsInverted = static_cast<bool>(params[PARAM_INVERT_1 + section].getValue());
-
-            // Clocks
-            if (clocksConnected[section]) {
-                clockTimers[section].process(args.sampleTime);
+            clockVoltages[section] = inputs[INPUT_CLOCK_1 + section].getVoltage();
+        }
+        int triggeredClocks = stClockTriggers.processBits(0, clockVoltages);
 
-                if (stClockTriggers[section].process(inputs[INPUT_CLOCK_1 + section].getVoltage(), 0.1f, 2.f)) {
-                    float clockFrequency = 1.f / clockTimers[section].getTime();
-                    clockTimers[section].reset();
-                    if (0.001f <= clockFrequency && clockFrequency <= 1000.f) {
-                        clockFrequencies[section] = clockFrequency;
-                    }
-                }
+        for (int section = 0; section < chronos::kMaxSections; ++section) {
+            if (clocksConnected[section]) {
+                clockFrequencies[section] = clockFollowers[section].process(triggeredClocks & (1 << section),
+                    args.sampleTime) * chronos::kClockRatios[clockRatios[section]];
             } else {
-                clockFrequencies[section] = 2.f;
+                clockFrequencies[section] = chronos::kFreeRunningFrequency;
             }
+        }
 
-            channelCounts[section] = std::max(inputs[INPUT_FM_1 + section].getChannels(), 1);
+        if (!bHaveCvRateSections && getSectionsMono()) {
+            processSectionsPacked(args, bIsLightsTurn, sampleTime);
+        } else {
+            for (int section = 0; section < chronos::kMaxSections; ++section) {
+                (this->*sectionKernels[section])(section, args, bIsLightsTurn, bIsCvRateTurn, sampleTime);
+            }
+        }
+    }
+
+    bool getSectionsMono() {
+        for (int section = 0; section < chronos::kMaxSections; ++section) {
+            if (inputs[INPUT_FM_1 + section].getChannels() > 1) {
+                return false;
+            }
+        }
+        return true;
+    }
 
-            for (size_t channel = 0; channel < channelCounts[section]; channel += 4) {
-                size_t currentChannel = channel >> 2;
+    /* With every section mono, one float_4 holds all four sections, a lane each, and a single pass computes them all.
+       Section phases stay in lane 0 of phaseAccumulators, so the polyphonic kernels pick up where this left off.
+       Unpatched inputs read 0 V, so their lanes need no connection tests. */
+    void processSectionsPacked(const ProcessArgs& args, const bool bIsLightsTurn, const float sampleTime) {
+        float_4 pitch;
+        float_4 fmAmounts;
+        float_4 fmVoltages;
+        float_4 pulseWidth;
+        float_4 pwmAmounts;
+        float_4 pwmVoltages;
+        float_4 sectionFrequencies;
+        float_4 offsets;
+        float_4 polarities;
+        float_4 resetVoltages;
+        chronos::PhaseAccumulator4 packedAccumulator;
+
+        bool bSineConnected = false;
 
-                // Pitch and frequency
-                float_4 pitch = paramFrequency;
-                if (fmsConnected[section]) {
-                    pitch += inputs[INPUT_FM_1 + section].getVoltageSimd<float_4>(channel) * paramFm;
-                }
+        for (int section = 0; section < chronos::kMaxSections; ++section) {
+            pitch[section] = params[PARAM_FREQUENCY_1 + section].getValue();
+            fmAmounts[section] = params[PARAM_FM_1 + section].getValue();
+            fmVoltages[section] = inputs[INPUT_FM_1 + section].getVoltage();
+            pulseWidth[section] = params[PARAM_PULSEWIDTH_1 + section].getValue();
+            pwmAmounts[section] = params[PARAM_PWM_1 + section].getValue();
+            pwmVoltages[section] = inputs[INPUT_PWM_1 + section].getVoltage();
+            sectionFrequencies[section] = clockFrequencies[section];
+            offsets[section] = !(static_cast<bool>(params[PARAM_BIPOLAR_1 + section].getValue()));
+            polarities[section] = static_cast<bool>(params[PARAM_INVERT_1 + section].getValue()) ? -1.f : 1.f;
+            resetVoltages[section] = inputs[INPUT_RESET_1 + section].getVoltage();
+            packedAccumulator.phases[section] = phaseAccumulators[section][0].phases[0];
+
+            bSineConnected |= sinesConnected[section];
+            channelCounts[section] = 1;
+        }
+
+        // Pitch and frequency
+        pitch += fmVoltages * fmAmounts;
+        float_4 frequency = sectionFrequencies / 2.f * dsp::exp2_taylor5(pitch);
+
+        // Pulse width
+        pulseWidth = clamp(pulseWidth + pwmVoltages / 10.f * pwmAmounts, 0.01f, 0.99f);
+
+        // Advance phase
+        packedAccumulator.advance(frequency * args.sampleTime);
+
+        // Reset, on lane 0 of each section's reset triggers so their state carries over between paths.
+        dsp::TSchmittTrigger<float_4> packedResetTrigger;
+        for (int section = 0; section < chronos::kMaxSections; ++section) {
+            packedResetTrigger.state[section] = stResetTriggers[section].triggers[0].state[0];
+        }
+
+        packedAccumulator.reset(packedResetTrigger.process(resetVoltages, stResetTriggers[0].lowThreshold,
+            stResetTriggers[0].highThreshold));
+
+        for (int section = 0; section < chronos::kMaxSections; ++section) {
+            stResetTriggers[section].triggers[0].state[0] = packedResetTrigger.state[section];
+        }
+
+        const float_4 packedPhases = packedAccumulator.getPhases();
+
+        // Waveforms, shifted and offset as in processSection.
+        float_4 sines = 0.f;
+        if (bSineConnected || bIsLightsTurn) {
+            sines = phaseSines::sin2Pi(packedPhases - 0.25f * offsets);
+        }
+
+        float_4 phase = packedPhases + 0.25f * (1.f - offsets);
+        const float_4 triangles = 4.f * simd::fabs(phase - simd::round(phase)) - 1.f;
+
+        phase = packedPhases - 0.5f * offsets;
+        const float_4 saws = 2.f * (phase - simd::round(phase));
+
+        const float_4 squares = simd::ifelse(packedPhases < pulseWidth, 1.f, -1.f);
+
+        const float_4 sineOutputs = 5.f * (sines * polarities + offsets);
+        const float_4 triangleOutputs = 5.f * (triangles * polarities + offsets);
+        const float_4 sawOutputs = 5.f * (saws * polarities + offsets);
+        const float_4 squareOutputs = 5.f * (squares * polarities + offsets);
+
+        for (int section = 0; section < chronos::kMaxSections; ++section) {
+            phaseAccumulators[section][0].phases[0] = packedAccumulator.phases[section];
+            sineVoltages[section][0][0] = sines[section];
+
+            outputs[OUTPUT_SINE_1 + section].setVoltage(sineOutputs[section]);
+            outputs[OUTPUT_TRIANGLE_1 + section].setVoltage(triangleOutputs[section]);
+            outputs[OUTPUT_SAW_1 + section].setVoltage(sawOutputs[section]);
+            outputs[OUTPUT_SQUARE_1 + section].setVoltage(squareOutputs[section]);
+
+            outputs[OUTPUT_SINE_1 + section].setChannels(1);
+            outputs[OUTPUT_TRIANGLE_1 + section].setChannels(1);
+            outputs[OUTPUT_SAW_1 + section].setChannels(1);
+            outputs[OUTPUT_SQUARE_1 + section].setChannels(1);
+
+            if (bIsLightsTurn) {
+                setSectionLights(section, sampleTime);
+            }
+        }
+    }
+
+    template <int ConnectionMask>
+    void processSection(const int section, const ProcessArgs& args, const bool bIsLightsTurn, const bool bIsCvRateTurn,
+        const float sampleTime) {
+        const bool bSineConnected = ConnectionMask & CONNECTION_SINE;
+        const bool bTriangleConnected = ConnectionMask & CONNECTION_TRIANGLE;
+        const bool bSawConnected = ConnectionMask & CONNECTION_SAW;
+        const bool bSquareConnected = ConnectionMask & CONNECTION_SQUARE;
+        // Only some sections run at CV rate: a branch per channel group costs less than twice the kernels.
+        const bool bCvRate = cvRates[section];
+
+        float paramFrequency = params[PARAM_FREQUENCY_1 + section].getValue();
+        float paramFm = params[PARAM_FM_1 + section].getValue();
+        float paramPulsewidth = params[PARAM_PULSEWIDTH_1 + section].getValue();
+        float paramPwm = params[PARAM_PWM_1 + section].getValue();
+        bool bHasOffset = !(static_cast<bool>(params[PARAM_BIPOLAR_1 + section].getValue()));
+        bool bIsInverted = static_cast<bool>(params[PARAM_INVERT_1 + section].getValue());
+
+        channelCounts[section] = std::max(inputs[INPUT_FM_1 + section].getChannels(), 1);
+
+        for (size_t channel = 0; channel < channelCounts[section]; channel += 4) {
+            size_t currentChannel = channel >> 2;
+
+            // Pitch and frequency
+            if (!bCvRate || bIsCvRateTurn) {
+                float_4 pitch = paramFrequency + inputs[INPUT_FM_1 + section].getVoltageSimd<float_4>(channel) * paramFm;
                 float_4 frequency = clockFrequencies[section] / 2.f * dsp::exp2_taylor5(pitch);
+                phaseIncrements[section][currentChannel] = frequency * args.sampleTime;
+            }
+
+            // Advance phase
+            phaseAccumulators[section][currentChannel].advance(phaseIncrements[section][currentChannel]);
 
-                // Pulse width
-                float_4 pulseWidth = paramPulsewidth;
-                if (pwmsConnected[section]) {
-                    pulseWidth += inputs[INPUT_PWM_1 + section].getPolyVoltageSimd<float_4>(channel) / 10.f * paramPwm;
+            // Reset
+            float_4 reset = inputs[INPUT_RESET_1 + section].getPolyVoltageSimd<float_4>(channel);
+            phaseAccumulators[section][currentChannel].reset(stResetTriggers[section].process(channel, reset));
+
+            // Between CV rate updates, outputs only follow their ramps.
+            if (bCvRate && !bIsCvRateTurn) {
+                chronos::CvRateRamp4* ramps = cvRateRamps[section][currentChannel];
+                if (bSineConnected) {
+                    outputs[OUTPUT_SINE_1 + section].setVoltageSimd(ramps[chronos::WAVEFORM_SINE].process(), channel);
+                }
+                if (bTriangleConnected) {
+                    outputs[OUTPUT_TRIANGLE_1 + section].setVoltageSimd(ramps[chronos::WAVEFORM_TRIANGLE].process(),
+                        channel);
+                }
+                if (bSawConnected) {
+                    outputs[OUTPUT_SAW_1 + section].setVoltageSimd(ramps[chronos::WAVEFORM_SAW].process(), channel);
                 }
-                pulseWidth = clamp(pulseWidth, 0.01f, 0.99f);
-
-                // Advance phase
-                float_4 deltaPhase = simd::fmin(frequency * args.sampleTime, 0.5f);
-                phases[section][currentChannel] += deltaPhase;
-                phases[section][currentChannel] -= simd::trunc(phases[section][currentChannel]);
-
-                // Reset
-                float_4 resetTriggered = {};
-                if (resetsConnected[section]) {
-                    float_4 reset = inputs[INPUT_RESET_1 + section].getPolyVoltageSimd<float_4>(channel);
-                    resetTriggered = stResetTriggers[section][currentChannel].process(reset, 0.1f, 2.f);
+                if (bSquareConnected) {
+                    outputs[OUTPUT_SQUARE_1 + section].setVoltageSimd(ramps[chronos::WAVEFORM_SQUARE].process(), channel);
                 }
-                phases[section][currentChannel] = simd::ifelse(resetTriggered, 0.f, phases[section][currentChannel]);
+                continue;
+            }
 
-                float_4 phase;
-                float_4 voltage;
+            // Pulse width
+            float_4 pulseWidth = paramPulsewidth +
+                inputs[INPUT_PWM_1 + section].getPolyVoltageSimd<float_4>(channel) / 10.f * paramPwm;
+            pulseWidth = clamp(pulseWidth, 0.01f, 0.99f);
 
-                // Sine
-                if (sinesConnected[section] || bIsLightsTurn) {
-                    phase = phases[section][currentChannel];
-                    if (bHasOffset) {
-                        phase -= 0.25f;
-                    }
-                    sineVoltages[section][currentChannel] = simd::sin(doublePi * phase);
-                    if (sinesConnected[section]) {
-                        voltage = sineVoltages[section][currentChannel];
-                        if (bIsInverted) {
-                            voltage = -voltage;
-                        }
+            const float_4 channelPhases = phaseAccumulators[section][currentChannel].getPhases();
 
-                        voltage += bHasOffset;
+            /* At CV rate, waveforms are evaluated where the phase will be on the sample before the next update and
+               ramped to from their current voltage; squares step. */
+            float_4 wavePhases = channelPhases;
+            if (bCvRate) {
+                wavePhases += phaseIncrements[section][currentChannel] * (chronos::kCvRateDivision - 1);
+                wavePhases -= simd::trunc(wavePhases);
+            }
 
-                        outputs[OUTPUT_SINE_1 + section].setVoltageSimd(5.f * voltage, channel);
-                    }
-                }
+            float_4 phase;
+            float_4 voltage;
 
-                // Triangle
-                if (trianglesConnected[section]) {
-                    phase = phases[section][currentChannel];
-                    if (!bHasOffset) {
-                        phase += 0.25f;
-                    }
-                    voltage = 4.f * simd::fabs(phase - simd::round(phase)) - 1.f;
+            // Sine
+            if (bSineConnected || bIsLightsTurn) {
+                phase = wavePhases;
+                if (bHasOffset) {
+                    phase -= 0.25f;
+                }
+                sineVoltages[section][currentChannel] = phaseSines::sin2Pi(phase);
+                if (bSineConnected) {
+                    voltage = sineVoltages[section][currentChannel];
                     if (bIsInverted) {
                         voltage = -voltage;
                     }
 
                     voltage += bHasOffset;
 
-                    outputs[OUTPUT_TRIANGLE_1 + section].setVoltageSimd(5.f * voltage, channel);
-                }
-
-                // Sawtooth
-                if (sawsConnected[section]) {
-                    phase = phases[section][currentChannel];
-                    if (bHasOffset) {
-                        phase -= 0.5f;
-                    }
-                    voltage = 2.f * (phase - simd::round(phase));
-                    if (bIsInverted) {
-                        voltage = -voltage;
+                    voltage *= 5.f;
+                    if (bCvRate) {
+                        voltage = cvRateRamps[section][currentChannel][chronos::WAVEFORM_SINE].rampTo(voltage);
                     }
-
-                    voltage += bHasOffset;
-                    outputs[OUTPUT_SAW_1 + section].setVoltageSimd(5.f * voltage, channel);
+                    outputs[OUTPUT_SINE_1 + section].setVoltageSimd(voltage, channel);
                 }
+            }
 
-                // Square
-                if (squaresConnected[section]) {
-                    voltage = simd::ifelse(phases[section][currentChannel] < pulseWidth, 1.f, -1.f);
-                    if (bIsInverted) {
-                        voltage = -voltage;
-                    }
+            // Triangle
+            if (bTriangleConnected) {
+                phase = wavePhases;
+                if (!bHasOffset) {
+                    phase += 0.25f;
+                }
+                voltage = 4.f * simd::fabs(phase - simd::round(phase)) - 1.f;
+                if (bIsInverted) {
+                    voltage = -voltage;
+                }
 
-                    voltage += bHasOffset;
+                voltage += bHasOffset;
 
-                    outputs[OUTPUT_SQUARE_1 + section].setVoltageSimd(5.f * voltage, channel);
+                voltage *= 5.f;
+                if (bCvRate) {
+                    voltage = cvRateRamps[section][currentChannel][chronos::WAVEFORM_TRIANGLE].rampTo(voltage);
                 }
+                outputs[OUTPUT_TRIANGLE_1 + section].setVoltageSimd(voltage, channel);
             }
 
-            outputs[OUTPUT_SINE_1 + section].setChannels(channelCounts[section]);
-            outputs[OUTPUT_TRIANGLE_1 + section].setChannels(channelCounts[section]);
-            outputs[OUTPUT_SAW_1 + section].setChannels(channelCounts[section]);
-            outputs[OUTPUT_SQUARE_1 + section].setChannels(channelCounts[section]);
+            // Sawtooth
+            if (bSawConnected) {
+                phase = wavePhases;
+                if (bHasOffset) {
+                    phase -= 0.5f;
+                }
+                voltage = 2.f * (phase - simd::round(phase));
+                if (bIsInverted) {
+                    voltage = -voltage;
+                }
 
-            if (bIsLightsTurn) {
-                if (ledsChannel[section] >= channelCounts[section]) {
-                    ledsChannel[section] = channelCounts[section] - 1;
+                voltage += bHasOffset;
+                voltage *= 5.f;
+                if (bCvRate) {
+                    voltage = cvRateRamps[section][currentChannel][chronos::WAVEFORM_SAW].rampTo(voltage);
                 }
+                outputs[OUTPUT_SAW_1 + section].setVoltageSimd(voltage, channel);
+            }
 
-                int currentLight = LIGHT_PHASE_1 + section * 3;
-                if (channelCounts[section] == 1) {
-                    lights[currentLight].setBrightnessSmooth(-sineVoltages[section][0][0], sampleTime);
-                    lights[currentLight + 1].setBrightnessSmooth(sineVoltages[section][0][0], sampleTime);
-                    lights[currentLight + 2].setBrightnessSmooth(0.f, sampleTime);
-                } else {
-                    float brightness = sineVoltages[section][ledsChannel[section] >> 2][ledsChannel[section] % 4];
-                    lights[currentLight].setBrightnessSmooth(-brightness, sampleTime);
-                    lights[currentLight + 1].setBrightnessSmooth(brightness, sampleTime);
-                    lights[currentLight + 2].setBrightnessSmooth(fabsf(brightness), sampleTime);
+            // Square
+            if (bSquareConnected) {
+                voltage = simd::ifelse(channelPhases < pulseWidth, 1.f, -1.f);
+                if (bIsInverted) {
+                    voltage = -voltage;
                 }
 
-#ifdef METAMODULE
-                lights[LIGHT_INVERT_1 + section].setBrightness(static_cast<bool>(params[PARAM_INVERT_1 + section].getValue()) *
-                    kSanguineButtonLightValue);
-                lights[LIGHT_BIPOLAR_1 + section].setBrightness(static_cast<bool>(params[PARAM_BIPOLAR_1 + section].getValue()) *
-                    kSanguineButtonLightValue);
-#endif
+                voltage += bHasOffset;
+
+                voltage *= 5.f;
+                if (bCvRate) {
+                    voltage = cvRateRamps[section][currentChannel][chronos::WAVEFORM_SQUARE].step(voltage);
+                }
+                outputs[OUTPUT_SQUARE_1 + section].setVoltageSimd(voltage, channel);
             }
         }
+
+        outputs[OUTPUT_SINE_1 + section].setChannels(channelCounts[section]);
+        outputs[OUTPUT_TRIANGLE_1 + section].setChannels(channelCounts[section]);
+        outputs[OUTPUT_SAW_1 + section].setChannels(channelCounts[section]);
+        outputs[OUTPUT_SQUARE_1 + section].setChannels(channelCounts[section]);
+
+        if (bIsLightsTurn) {
+            setSectionLights(section, sampleTime);
+        }
+    }
+
+    void setSectionLights(const int section, const float sampleTime) {
+        if (ledsChannel[section] >= channelCounts[section]) {
+            ledsChannel[section] = channelCounts[section] - 1;
+        }
+
+        int currentLight = LIGHT_PHASE_1 + section * 3;
+        if (channelCounts[section] == 1) {
+            lights[currentLight].setBrightnessSmooth(-sineVoltages[section][0][0], sampleTime);
+            lights[currentLight + 1].setBrightnessSmooth(sineVoltages[section][0][0], sampleTime);
+            lights[currentLight + 2].setBrightnessSmooth(0.f, sampleTime);
+        } else {
+            float brightness = sineVoltages[section][ledsChannel[section] >> 2][ledsChannel[section] % 4];
+            lights[currentLight].setBrightnessSmooth(-brightness, sampleTime);
+            lights[currentLight + 1].setBrightnessSmooth(brightness, sampleTime);
+            lights[currentLight + 2].setBrightnessSmooth(fabsf(brightness), sampleTime);
+        }
+
+#ifdef METAMODULE
+        lights[LIGHT_INVERT_1 + section].setBrightness(static_cast<bool>(params[PARAM_INVERT_1 + section].getValue()) *
+            kSanguineButtonLightValue);
+        lights[LIGHT_BIPOLAR_1 + section].setBrightness(static_cast<bool>(params[PARAM_BIPOLAR_1 + section].getValue()) *
+            kSanguineButtonLightValue);
+#endif
     }
 
     void init() {
@@ -371,11 +593,11 @@ struct Chronos : SanguineModule {
         const float phaseOffset = 0.25f;
         for (int section = 0; section < chronos::kMaxSections; ++section) {
             for (int channel = 0; channel < 16; channel += 4) {
-                phases[section][channel >> 2] = newPhase;
+                phaseAccumulators[section][channel >> 2].setPhases(newPhase);
             }
             newPhase += phaseOffset;
             clockFrequencies[section] = 1.f;
-            clockTimers[section].reset();
+            clockFollowers[section].reset();
         }
     }
 
@@ -389,63 +611,22 @@ struct Chronos : SanguineModule {
             switch (e.portId) {
             case INPUT_CLOCK_1:
                 clocksConnected[0] = e.connecting;
+                clockFollowers[0].reset();
                 break;
 
             case INPUT_CLOCK_2:
                 clocksConnected[1] = e.connecting;
+                clockFollowers[1].reset();
                 break;
 
             case INPUT_CLOCK_3:
                 clocksConnected[2] = e.connecting;
+                clockFollowers[2].reset();
                 break;
 
             case INPUT_CLOCK_4:
                 clocksConnected[3] = e.connecting;
-                break;
-
-            case INPUT_RESET_1:
-                resetsConnected[0] = e.connecting;
-                break;
-
-            case INPUT_RESET_2:
-                resetsConnected[1] = e.connecting;
-                break;
-
-            case INPUT_RESET_3:
-                resetsConnected[2] = e.connecting;
-                break;
-
-            case INPUT_RESET_4:
-                resetsConnected[3] = e.connecting;
-                break;
-
-            case INPUT_FM_1:
-                fmsConnected[0] = e.connecting;
-                break;
-
-            case INPUT_FM_2:
-                fmsConnected[1] = e.connecting;
-                break;
-
-            case INPUT_FM_3:
-                fmsConnected[2] = e.connecting;
-                break;
-
-            case INPUT_FM_4:
-                fmsConnected[3] = e.connecting;
-                break;
-
-            case INPUT_PWM_1:
-                pwmsConnected[0] = e.connecting;
-                break;
-            case INPUT_PWM_2:
-                pwmsConnected[1] = e.connecting;
-                break;
-            case INPUT_PWM_3:
-                pwmsConnected[2] = e.connecting;
-                break;
-            case INPUT_PWM_4:
-                pwmsConnected[3] = e.connecting;
+                clockFollowers[3].reset();
                 break;
             }
             break;
@@ -518,6 +699,51 @@ struct Chronos : SanguineModule {
             }
             break;
         }
+
+        updateSectionKernels();
+    }
+
+    void updateSectionKernels() {
+        static const kernelTables::KernelTable<SectionKernel, CONNECTIONS_COUNT, ConnectedKernel> kernelTable;
+
+        for (int section = 0; section < chronos::kMaxSections; ++section) {
+            int connectionMask = 0;
+
+            connectionMask |= sinesConnected[section] * CONNECTION_SINE;
+            connectionMask |= trianglesConnected[section] * CONNECTION_TRIANGLE;
+            connectionMask |= sawsConnected[section] * CONNECTION_SAW;
+            connectionMask |= squaresConnected[section] * CONNECTION_SQUARE;
+
+            sectionKernels[section] = kernelTable.kernels[connectionMask];
+        }
+    }
+
+    void requestCvRate(const int section, const bool bCvRate) {
+        pendingCvRates[section] = bCvRate;
+        bHavePendingCvRates.store(true, std::memory_order_release);
+    }
+
+    /* Sections switched to CV rate start their ramps from the voltages they last output, so they hold them until
+       their first update instead of playing whatever their ramps held from before. */
+    void applyCvRates() {
+        bHaveCvRateSections = false;
+
+        for (int section = 0; section < chronos::kMaxSections; ++section) {
+            if (pendingCvRates[section] && !cvRates[section]) {
+                for (int channel = 0; channel < PORT_MAX_CHANNELS; channel += 4) {
+                    chronos::CvRateRamp4* ramps = cvRateRamps[section][channel >> 2];
+                    ramps[chronos::WAVEFORM_SINE].step(outputs[OUTPUT_SINE_1 + section].getVoltageSimd<float_4>(channel));
+                    ramps[chronos::WAVEFORM_TRIANGLE].step(
+                        outputs[OUTPUT_TRIANGLE_1 + section].getVoltageSimd<float_4>(channel));
+                    ramps[chronos::WAVEFORM_SAW].step(outputs[OUTPUT_SAW_1 + section].getVoltageSimd<float_4>(channel));
+                    ramps[chronos::WAVEFORM_SQUARE].step(
+                        outputs[OUTPUT_SQUARE_1 + section].getVoltageSimd<float_4>(channel));
+                }
+            }
+
+            cvRates[section] = pendingCvRates[section];
+            bHaveCvRateSections |= cvRates[section];
+        }
     }
 
     json_t* dataToJson() override {
@@ -525,6 +751,8 @@ struct Chronos : SanguineModule {
 
         for (int section = 0; section < chronos::kMaxSections; ++section) {
             setJsonInt(rootJ, string::f("ledsChannel%d", section).c_str(), ledsChannel[section]);
+            setJsonInt(rootJ, string::f("clockRatio%d", section).c_str(), clockRatios[section]);
+            setJsonBoolean(rootJ, string::f("cvRate%d", section).c_str(), pendingCvRates[section]);
         }
         return rootJ;
     }
@@ -538,7 +766,17 @@ struct Chronos : SanguineModule {
             if (getJsonInt(rootJ, string::f("ledsChannel%d", section).c_str(), intValue)) {
                 ledsChannel[section] = intValue;
             }
+
+            if (getJsonInt(rootJ, string::f("clockRatio%d", section).c_str(), intValue)) {
+                clockRatios[section] = clamp(static_cast<int>(intValue), 0,
+                    static_cast<int>(chronos::kClockRatioLabels.size()) - 1);
+            }
+
+            getJsonBoolean(rootJ, string::f("cvRate%d", section).c_str(), pendingCvRates[section]);
         }
+
+        applyCvRates();
+        updateSectionKernels();
     }
 };
 
@@ -788,6 +1026,25 @@ struct ChronosWidget : SanguineModuleWidget {
                 [=](int i) {module->ledsChannel[section] = i; }
             ));
         }
+
+        menu->addChild(new MenuSeparator);
+
+        for (int section = 0; section < chronos::kMaxSections; ++section) {
+            menu->addChild(createIndexSubmenuItem(string::f("Section %d clock ratio", section + 1),
+                chronos::kClockRatioLabels,
+                [=]() {return module->clockRatios[section]; },
+                [=](int i) {module->clockRatios[section] = i; }
+            ));
+        }
+
+        menu->addChild(new MenuSeparator);
+
+        for (int section = 0; section < chronos::kMaxSections; ++section) {
+            menu->addChild(createCheckMenuItem(string::f("Section %d at CV rate", section + 1), "",
+                [=]() {return module->pendingCvRates[section]; },
+                [=]() {module->requestCvRate(section, !module->pendingCvRates[section]); }
+            ));
+        }
     }
 };
 
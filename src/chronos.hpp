@@ -1,5 +1,164 @@
 #pragma once
 
+using simd::float_4;
+using simd::int32_4;
+
 namespace chronos {
     static const int kMaxSections = 4;
-}
\ No newline at end of file
+
+    static const std::vector<std::string> kClockRatioLabels = {
+        "/4", "/3", "/2", "x1", "x2", "x3", "x4"
+    };
+
+    static const float kClockRatios[] = { 1.f / 4.f, 1.f / 3.f, 1.f / 2.f, 1.f, 2.f, 3.f, 4.f };
+
+    static const int kDefaultClockRatio = 3;
+
+    enum Waveforms {
+        WAVEFORM_SINE,
+        WAVEFORM_TRIANGLE,
+        WAVEFORM_SAW,
+        WAVEFORM_SQUARE,
+        WAVEFORMS_COUNT
+    };
+
+    // Samples between waveform updates for sections at CV rate.
+    static const int kCvRateDivision = 16;
+
+    static constexpr float kPhaseSteps = 4294967296.f;
+    // Largest float below half a cycle; half a cycle itself doesn't fit an int32.
+    static constexpr float kMaxPhaseIncrement = 0.5f - 1.f / 33554432.f;
+
+    /* Phases for four lanes as 32-bit fixed point, kPhaseSteps to a cycle.
+       Wrapping is integer overflow, so it is exact, and lanes advanced by the same increments keep their distance
+       however long the module runs; float phases lose increment bits as they grow and drift apart.
+       The integers hold the phase shifted by half a cycle, keeping it in the signed range of the conversions. */
+    struct PhaseAccumulator4 {
+        int32_4 phases = INT32_MIN;
+
+        void setPhases(const float_4 newPhases) {
+            phases = int32_4((newPhases - 0.5f) * kPhaseSteps);
+        }
+
+        // Increments are in cycles per sample, rounded to the nearest step so slow rates don't run flat.
+        void advance(const float_4 increments) {
+            phases += int32_4(simd::round(simd::fmin(increments, kMaxPhaseIncrement) * kPhaseSteps));
+        }
+
+        void reset(const float_4 resetLanes) {
+            phases = phases ^ ((phases ^ int32_4(INT32_MIN)) & int32_4::cast(resetLanes));
+        }
+
+        float_4 getPhases() const {
+            return float_4(phases) * (1.f / kPhaseSteps) + 0.5f;
+        }
+    };
+
+    // A waveform's voltages for four lanes between CV rate updates.
+    struct CvRateRamp4 {
+        float_4 voltages = 0.f;
+        float_4 slopes = 0.f;
+
+        // Starts a ramp reaching the target in kCvRateDivision samples; returns this sample's voltages.
+        float_4 rampTo(const float_4 target) {
+            slopes = (target - voltages) * (1.f / kCvRateDivision);
+            return process();
+        }
+
+        // Holds the target until the next update.
+        float_4 step(const float_4 target) {
+            voltages = target;
+            slopes = 0.f;
+            return voltages;
+        }
+
+        float_4 process() {
+            voltages += slopes;
+            return voltages;
+        }
+    };
+
+    static const float kFreeRunningFrequency = 2.f;
+    static const float kMinClockFrequency = 0.001f;
+    static const float kMaxClockFrequency = 1000.f;
+
+    /* Follows a section's clock input with a phase-locked loop.
+       The period is smoothed over several edges, so a jittery clock doesn't jump the LFO rate, and every edge pulls
+       the follower's phase back towards a whole cycle, so LFOs running at a ratio of its frequency keep their phase
+       against the clock.
+       Between edges the follower is a plain accumulator: the loop itself only runs on edges. */
+    struct ClockFollower {
+        float frequency = kFreeRunningFrequency;
+        float period = 1.f / kFreeRunningFrequency;
+        float elapsed = 0.f;
+        // Cycles since the last edge.
+        float phase = 0.f;
+        bool bHaveEdge = false;
+        bool bLocked = false;
+
+        // Fraction of the period error taken on each edge.
+        static constexpr float kPeriodSmoothing = 0.25f;
+        // Fraction of the phase error corrected over the next period.
+        static constexpr float kPhaseGain = 0.5f;
+        /* Measured periods further than this from the estimate are a new tempo, followed from that edge on.
+           That includes whole multiples of the estimate: a dropped edge can't be told from a slower clock until
+           the next one arrives, and a real tempo change shouldn't wait for it. */
+        static constexpr float kMaxPeriodDeviation = 0.2f;
+        // Periods without an edge before the follower slows down with a stopped clock.
+        static constexpr float kOverduePeriods = 2.f;
+
+        void reset() {
+            frequency = kFreeRunningFrequency;
+            period = 1.f / kFreeRunningFrequency;
+            elapsed = 0.f;
+            phase = 0.f;
+            bHaveEdge = false;
+            bLocked = false;
+        }
+
+        // Returns the followed frequency.
+        float process(const bool bEdge, const float sampleTime) {
+            elapsed += sampleTime;
+            phase += frequency * sampleTime;
+
+            if (bEdge) {
+                processEdge();
+            } else if (bLocked && elapsed > kOverduePeriods * period) {
+                // A stopped clock shouldn't leave a stale rate behind.
+                frequency = std::min(frequency, kOverduePeriods / elapsed);
+            }
+            return frequency;
+        }
+
+    private:
+        void processEdge() {
+            const float measuredPeriod = elapsed;
+            elapsed = 0.f;
+
+            if (!bHaveEdge) {
+                // The first edge only starts timing.
+                bHaveEdge = true;
+                phase = 0.f;
+                return;
+            }
+
+            if (measuredPeriod * kMinClockFrequency > 1.f || measuredPeriod * kMaxClockFrequency < 1.f) {
+                return;
+            }
+
+            if (!bLocked || std::fabs(measuredPeriod / period - 1.f) > kMaxPeriodDeviation) {
+                period = measuredPeriod;
+                frequency = 1.f / period;
+                phase = 0.f;
+                bLocked = true;
+                return;
+            }
+
+            period += kPeriodSmoothing * (measuredPeriod - period);
+
+            // Edges should land on whole cycles; whatever is left over is corrected over the next period.
+            phase -= std::round(phase);
+            frequency = (1.f - kPhaseGain * phase) / period;
+        }
+    };
+}
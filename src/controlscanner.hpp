@@ -0,0 +1,34 @@
+#pragma once
+
+#include <rack.hpp>
+
+namespace controlScanners {
+    /* Panel buttons scanned at control rate, on a module's clock divider turn.
+       The buttons are Count consecutive params starting at firstParam; button n is firstParam + n. */
+    template <int Count>
+    struct ButtonScanner {
+        rack::dsp::BooleanTrigger buttonTriggers[Count];
+
+        // Returns a bitmask with bit n set when button n was pressed since the last scan.
+        int scan(std::vector<rack::engine::Param>& params, const int firstParam) {
+            int pressedButtons = 0;
+            for (int button = 0; button < Count; ++button) {
+                if (buttonTriggers[button].process(params[firstParam + button].getValue())) {
+                    pressedButtons |= 1 << button;
+                }
+            }
+            return pressedButtons;
+        }
+
+        /* Writes the module's own state back to a button, only when it changed.
+           The button's trigger sees the written value too, so the next scan doesn't take it for a press. */
+        void setButton(std::vector<rack::engine::Param>& params, const int firstParam, const int button,
+            const float value) {
+            rack::engine::Param& param = params[firstParam + button];
+            if (param.getValue() != value) {
+                param.setValue(value);
+                buttonTriggers[button].process(value);
+            }
+        }
+    };
+}
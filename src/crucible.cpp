@@ -11,6 +11,63 @@ Crucible::Crucible() {
     configInput(INPUT_MUTE_POLY, "Mute channels");
     configInput(INPUT_SOLO_ALL, "Solo all");
     configInput(INPUT_SOLO_POLY, "Solo channels");
+
+    rightExpander.producerMessage = &statusMessages[0];
+    rightExpander.consumerMessage = &statusMessages[1];
+
+    lightsDivider.setDivision(kLightsFrequency);
+}
+
+void Crucible::process(const ProcessArgs& args) {
+    Module* alchemistMaster = getRightExpander().module;
+
+    if (alchemistMaster && alchemistMaster->getModel() == modelAlchemist && !alchemistMaster->isBypassed()) {
+        const crucible::StatusMessage* statusMessage =
+            static_cast<crucible::StatusMessage*>(rightExpander.consumerMessage);
+
+        bool bMuteExclusive = static_cast<bool>(params[PARAM_MUTE_EXCLUSIVE].getValue());
+        bool bSoloExclusive = static_cast<bool>(params[PARAM_SOLO_EXCLUSIVE].getValue());
+
+        if (bMuteExclusive || statusMessage->bClearMuteAll) {
+            params[PARAM_MUTE_ALL].setValue(0.f);
+        }
+
+        if (bSoloExclusive || statusMessage->bClearSoloAll) {
+            params[PARAM_SOLO_ALL].setValue(0.f);
+        }
+
+        crucible::ControlsMessage* controlsMessage =
+            static_cast<crucible::ControlsMessage*>(alchemistMaster->leftExpander.producerMessage);
+
+        controlsMessage->bMuteExclusive = bMuteExclusive;
+        controlsMessage->bSoloExclusive = bSoloExclusive;
+
+        controlsMessage->bMuteAll = static_cast<bool>(params[PARAM_MUTE_ALL].getValue()) |
+            (inputs[INPUT_MUTE_ALL].getVoltage() >= 1.f);
+        controlsMessage->bSoloAll = static_cast<bool>(params[PARAM_SOLO_ALL].getValue()) |
+            (inputs[INPUT_SOLO_ALL].getVoltage() >= 1.f);
+
+        controlsMessage->muteChannelCount = inputs[INPUT_MUTE_POLY].getChannels();
+        controlsMessage->soloChannelCount = inputs[INPUT_SOLO_POLY].getChannels();
+
+        inputs[INPUT_MUTE_POLY].readVoltages(controlsMessage->muteVoltages);
+        inputs[INPUT_SOLO_POLY].readVoltages(controlsMessage->soloVoltages);
+
+        alchemistMaster->leftExpander.requestMessageFlip();
+
+        if (lightsDivider.process()) {
+            const float sampleTime = kLightsFrequency * args.sampleTime;
+
+            lights[LIGHT_MUTE_ALL].setBrightnessSmooth(statusMessage->bMuteAllEnabled *
+                kSanguineButtonLightValue, sampleTime);
+            lights[LIGHT_SOLO_ALL].setBrightnessSmooth(statusMessage->bSoloAllEnabled *
+                kSanguineButtonLightValue, sampleTime);
+            lights[LIGHT_MUTE_EXCLUSIVE].setBrightnessSmooth(statusMessage->bMuteExclusiveEnabled *
+                kSanguineButtonLightValue, sampleTime);
+            lights[LIGHT_SOLO_EXCLUSIVE].setBrightnessSmooth(statusMessage->bSoloExclusiveEnabled *
+                kSanguineButtonLightValue, sampleTime);
+        }
+    }
 }
 
 void Crucible::onExpanderChange(const ExpanderChangeEvent& e) {
@@ -6,6 +6,33 @@
 
 using namespace sanguineCommonCode;
 
+namespace crucible {
+    // Crucible to Alchemist.
+    struct ControlsMessage {
+        bool bMuteAll = false;
+        bool bMuteExclusive = false;
+        bool bSoloAll = false;
+        bool bSoloExclusive = false;
+
+        int muteChannelCount = 0;
+        int soloChannelCount = 0;
+
+        float muteVoltages[PORT_MAX_CHANNELS] = {};
+        float soloVoltages[PORT_MAX_CHANNELS] = {};
+    };
+
+    // Alchemist to Crucible.
+    struct StatusMessage {
+        bool bMuteAllEnabled = false;
+        bool bMuteExclusiveEnabled = false;
+        bool bSoloAllEnabled = false;
+        bool bSoloExclusiveEnabled = false;
+
+        bool bClearMuteAll = false;
+        bool bClearSoloAll = false;
+    };
+}
+
 struct Crucible : SanguineModule {
     enum ParamIds {
         PARAM_MUTE_ALL,
@@ -39,8 +66,16 @@ struct Crucible : SanguineModule {
 
     Crucible();
 
+    void process(const ProcessArgs& args) override;
+
     void onExpanderChange(const ExpanderChangeEvent& e) override;
 
 private:
+    const int kLightsFrequency = 256;
+
     bool bHadMaster = false;
+
+    dsp::ClockDivider lightsDivider;
+
+    crucible::StatusMessage statusMessages[2];
 };
\ No newline at end of file
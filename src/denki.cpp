@@ -8,6 +8,96 @@ Denki::Denki() {
 		configInput(INPUT_GAIN_CV + section, string::f("Channel %d gain CV", channelNumber));
 		configInput(INPUT_OFFSET_CV + section, string::f("Channel %d offset CV", channelNumber));
 	}
+
+	leftExpander.producerMessage = &statusMessages[0];
+	leftExpander.consumerMessage = &statusMessages[1];
+
+	lightsDivider.setDivision(kLightsFrequency);
+}
+
+void Denki::process(const ProcessArgs& args) {
+	Module* kitsuneMaster = getLeftExpander().module;
+
+	if (kitsuneMaster && kitsuneMaster->getModel() == modelKitsune && !kitsuneMaster->isBypassed()) {
+		denki::ControlsMessage* controlsMessage =
+			static_cast<denki::ControlsMessage*>(kitsuneMaster->rightExpander.producerMessage);
+
+		for (int section = 0; section < kitsune::kMaxSections; ++section) {
+			controlsMessage->gainsConnected[section] = gainsConnected[section];
+			controlsMessage->offsetsConnected[section] = offsetsConnected[section];
+
+			if (gainsConnected[section]) {
+				Input& input = inputs[INPUT_GAIN_CV + section];
+				for (int channel = 0; channel < PORT_MAX_CHANNELS; channel += 4) {
+					controlsMessage->gainVoltages[section][channel >> 2] = input.getVoltageSimd<float_4>(channel);
+				}
+			}
+
+			if (offsetsConnected[section]) {
+				Input& input = inputs[INPUT_OFFSET_CV + section];
+				for (int channel = 0; channel < PORT_MAX_CHANNELS; channel += 4) {
+					controlsMessage->offsetVoltages[section][channel >> 2] = input.getVoltageSimd<float_4>(channel);
+				}
+			}
+		}
+
+		kitsuneMaster->rightExpander.requestMessageFlip();
+
+		if (lightsDivider.process()) {
+			const float sampleTime = kLightsFrequency * args.sampleTime;
+
+			const denki::StatusMessage* statusMessage =
+				static_cast<denki::StatusMessage*>(leftExpander.consumerMessage);
+
+			for (int section = 0; section < kitsune::kMaxSections; ++section) {
+				if (statusMessage->channelCounts[section] == 1) {
+					setMonoLights(section, sampleTime);
+				} else {
+					setPolyLights(section, statusMessage->channelCounts[section], sampleTime);
+				}
+			}
+		}
+	}
+}
+
+void Denki::setMonoLights(const int section, const float sampleTime) {
+	const int currentGainLight = LIGHT_GAIN_CV + section * 3;
+	float rescaledLight = math::rescale(inputs[INPUT_GAIN_CV + section].getVoltage(), 0.f, 10.f, 0.f, 1.f);
+	lights[currentGainLight].setBrightnessSmooth(-rescaledLight, sampleTime);
+	lights[currentGainLight + 1].setBrightnessSmooth(rescaledLight, sampleTime);
+	lights[currentGainLight + 2].setBrightnessSmooth(0.f, sampleTime);
+
+	const int currentOffsetLight = LIGHT_OFFSET_CV + section * 3;
+	rescaledLight = math::rescale(inputs[INPUT_OFFSET_CV + section].getVoltage(), 0.f, 10.f, 0.f, 1.f);
+	lights[currentOffsetLight].setBrightnessSmooth(-rescaledLight, sampleTime);
+	lights[currentOffsetLight + 1].setBrightnessSmooth(rescaledLight, sampleTime);
+	lights[currentOffsetLight + 2].setBrightnessSmooth(0.f, sampleTime);
+}
+
+void Denki::setPolyLights(const int section, const int channelCount, const float sampleTime) {
+	float cvGainLightValue = 0.f;
+	float cvOffsetLightValue = 0.f;
+
+	for (int channel = 0; channel < channelCount; ++channel) {
+		cvGainLightValue += inputs[INPUT_GAIN_CV + section].getVoltage(channel);
+		cvOffsetLightValue += inputs[INPUT_OFFSET_CV + section].getVoltage(channel);
+	}
+
+	if (channelCount > 0) {
+		cvGainLightValue /= channelCount;
+		cvOffsetLightValue /= channelCount;
+	}
+
+	setCvLight(LIGHT_GAIN_CV + section * 3, cvGainLightValue, sampleTime);
+	setCvLight(LIGHT_OFFSET_CV + section * 3, cvOffsetLightValue, sampleTime);
+}
+
+void Denki::setCvLight(const int light, const float voltage, const float sampleTime) {
+	float rescaledLight = math::rescale(voltage, 0.f, 10.f, 0.f, 1.f);
+
+	lights[light].setBrightnessSmooth(-rescaledLight, sampleTime);
+	lights[light + 1].setBrightnessSmooth(rescaledLight, sampleTime);
+	lights[light + 2].setBrightnessSmooth(voltage < 0 ? -rescaledLight : rescaledLight, sampleTime);
 }
 
 void Denki::onExpanderChange(const ExpanderChangeEvent& e) {
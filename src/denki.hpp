@@ -5,6 +5,27 @@
 #include "sanguinehelpers.hpp"
 #include "kitsunecommon.hpp"
 
+using simd::float_4;
+
+namespace denki {
+	/* Messages are double-buffered by the engine: whatever one module sends
+	   is read by the other on the next sample. */
+
+	// Denki to Kitsune.
+	struct ControlsMessage {
+		float_4 gainVoltages[kitsune::kMaxSections][PORT_MAX_CHANNELS / 4] = {};
+		float_4 offsetVoltages[kitsune::kMaxSections][PORT_MAX_CHANNELS / 4] = {};
+
+		bool gainsConnected[kitsune::kMaxSections] = {};
+		bool offsetsConnected[kitsune::kMaxSections] = {};
+	};
+
+	// Kitsune to Denki.
+	struct StatusMessage {
+		int channelCounts[kitsune::kMaxSections] = {};
+	};
+}
+
 struct Denki : SanguineModule {
 
 	enum ParamIds {
@@ -31,6 +52,8 @@ struct Denki : SanguineModule {
 
 	Denki();
 
+	void process(const ProcessArgs& args) override;
+
 	inline bool getGainConnected(const int port) const {
 		return gainsConnected[port];
 	}
@@ -52,6 +75,16 @@ struct Denki : SanguineModule {
 	void onPortChange(const PortChangeEvent& e) override;
 
 private:
+	const int kLightsFrequency = 64;
+
 	bool gainsConnected[kitsune::kMaxSections] = {};
 	bool offsetsConnected[kitsune::kMaxSections] = {};
+
+	dsp::ClockDivider lightsDivider;
+
+	denki::StatusMessage statusMessages[2];
+
+	void setMonoLights(const int section, const float sampleTime);
+	void setPolyLights(const int section, const int channelCount, const float sampleTime);
+	void setCvLight(const int light, const float voltage, const float sampleTime);
 };
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <atomic>
+
+namespace displaySnapshots {
+    /* Lock-free triple buffer handing display state from the engine to the UI.
+       The engine fills getWriteBuffer() completely and calls publish(); the UI calls consume() and,
+       when it returns true, reads the newest snapshot from getReadBuffer().
+       Neither side ever waits for the other and the UI never sees a half written snapshot. */
+    template <typename Snapshot>
+    struct TripleBuffer {
+        Snapshot buffers[3] = {};
+
+        TripleBuffer() : middleIndex(1) {}
+
+        // Engine side.
+        Snapshot& getWriteBuffer() {
+            return buffers[writeIndex];
+        }
+
+        void publish() {
+            writeIndex = middleIndex.exchange(writeIndex | kNewSnapshot, std::memory_order_acq_rel) & kIndexMask;
+        }
+
+        // UI side.
+        bool consume() {
+            if (!(middleIndex.load(std::memory_order_relaxed) & kNewSnapshot)) {
+                return false;
+            }
+            readIndex = middleIndex.exchange(readIndex, std::memory_order_acq_rel) & kIndexMask;
+            return true;
+        }
+
+        const Snapshot& getReadBuffer() const {
+            return buffers[readIndex];
+        }
+
+    private:
+        static const int kIndexMask = 0x3;
+        static const int kNewSnapshot = 0x4;
+
+        // Index of the buffer between writer and reader; kNewSnapshot marks it as not yet consumed.
+        std::atomic<int> middleIndex;
+        int writeIndex = 0;
+        int readIndex = 2;
+    };
+}
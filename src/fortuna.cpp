@@ -5,6 +5,15 @@
 #include "sanguinedsp.hpp"
 #include "sanguinejson.hpp"
 
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wunused-but-set-parameter"
+#include "pcg_random.hpp"
+#pragma GCC diagnostic pop
+
+#include <atomic>
+
+#include "triggerbank.hpp"
+
 #include "fortuna.hpp"
 
 using namespace sanguineCommonCode;
@@ -50,12 +59,20 @@ struct Fortuna : SanguineModule {
     int ledsChannel = 0;
     int channelCount = 0;
 
-    dsp::BooleanTrigger btGateTriggers[kMaxModuleSections][PORT_MAX_CHANNELS];
+    uint64_t rngSeed = 0;
+    // Set from the UI thread, applied in process() so the generator isn't reseeded while it runs.
+    uint64_t pendingSeed = 0;
+    std::atomic<bool> bHavePendingSeed{ false };
+
+    triggerBanks::SchmittTriggerBank<> stGateTriggers[kMaxModuleSections];
     dsp::ClockDivider lightsDivider;
-    RampGenerator rampGenerators[kMaxModuleSections][PORT_MAX_CHANNELS];
+    fortuna::RampGenerator4 rampGenerators[kMaxModuleSections][PORT_MAX_CHANNELS / 4];
 
-    fortuna::RollResults rollResults[kMaxModuleSections][PORT_MAX_CHANNELS] = {};
-    fortuna::RollResults lastRollResults[kMaxModuleSections][PORT_MAX_CHANNELS] = {};
+    pcg32 pcgRng;
+
+    // Lanes hold fortuna::RollResults.
+    float_4 rollResults[kMaxModuleSections][PORT_MAX_CHANNELS / 4] = {};
+    float_4 cvVoltages[kMaxModuleSections][PORT_MAX_CHANNELS / 4] = {};
 
     fortuna::RollModes rollModes[kMaxModuleSections] = { fortuna::ROLL_DIRECT, fortuna::ROLL_DIRECT };
     bool inputsConnected[kMaxModuleSections] = {};
@@ -74,14 +91,22 @@ struct Fortuna : SanguineModule {
             configInput(INPUT_P_1 + section, string::f("Channel %d probability", section + 1));
             configOutput(OUTPUT_OUT_1A + section, string::f("Channel %d A", section + 1));
             configOutput(OUTPUT_OUT_1B + section, string::f("Channel %d B", section + 1));
+
+            // Gates are high from 2V, without hysteresis.
+            stGateTriggers[section].setThresholds(2.f, 2.f);
         }
 
         lightsDivider.setDivision(kLightsFrequency);
+
+        setSeed(random::u64());
     }
 
     void process(const ProcessArgs& args) override {
-        float inVoltages[kMaxModuleSections][PORT_MAX_CHANNELS] = {};
-        float cvVoltages[kMaxModuleSections][PORT_MAX_CHANNELS] = {};
+        if (bHavePendingSeed.load(std::memory_order_acquire)) {
+            setSeed(pendingSeed);
+            bHavePendingSeed.store(false, std::memory_order_relaxed);
+        }
+
         bool bLightsTurn = lightsDivider.process();
 
         for (int section = 0; section < kMaxModuleSections; ++section) {
@@ -103,39 +128,32 @@ struct Fortuna : SanguineModule {
             rollModes[section] = static_cast<fortuna::RollModes>(params[PARAM_ROLL_MODE_1 + section].getValue());
 
             float rampDuration = params[PARAM_CROSSFADE_A + section].getValue();
+            float paramThreshold = params[PARAM_THRESHOLD_1 + section].getValue();
+
+            for (int channel = 0; channel < channelCount; channel += 4) {
+                const int currentChannel = channel >> 2;
 
-            // Process triggers.
-            for (int channel = 0; channel < channelCount; ++channel) {
-                cvVoltages[section][channel] = inputs[INPUT_P_1 + section].getVoltage(channel);
-
-                bool bGatePresent = trigger->getVoltage(channel) >= 2.f;
-                if (btGateTriggers[section][channel].process(bGatePresent)) {
-                    // Trigger.
-                    float threshold = clamp(params[PARAM_THRESHOLD_1 + section].getValue() + cvVoltages[section][channel] / 5.f, 0.f, 1.f);
-                    rollResults[section][channel] = (random::uniform() >= threshold) ? fortuna::ROLL_HEADS : fortuna::ROLL_TAILS;
-                    if (rollModes[section] == fortuna::ROLL_TOGGLE) {
-                        rollResults[section][channel] =
-                            static_cast<fortuna::RollResults>(lastRollResults[section][channel] ^ rollResults[section][channel]);
-                    }
-                    if (lastRollResults[section][channel] != rollResults[section][channel]) {
-                        rampGenerators[section][channel].trigger(rampDuration);
-                    }
-                    lastRollResults[section][channel] = rollResults[section][channel];
+                cvVoltages[section][currentChannel] = inputs[INPUT_P_1 + section].getVoltageSimd<float_4>(channel);
+
+                // Process triggers.
+                int triggeredLanes = simd::movemask(stGateTriggers[section].process(channel,
+                    trigger->getVoltageSimd<float_4>(channel)));
+                if (triggeredLanes) {
+                    rollCoins(section, channel, triggeredLanes, paramThreshold, rampDuration);
                 }
 
-                rampGenerators[section][channel].process(args.sampleTime);
+                rampGenerators[section][currentChannel].process(args.sampleTime);
 
                 // Set output signals
-                inVoltages[section][channel] = input->getVoltage(channel);
+                float_4 inVoltages = input->getVoltageSimd<float_4>(channel);
 
-                float fadingOutVoltage = crossfade(inVoltages[section][channel], 0.f, rampGenerators[section][channel].rampVoltage);
-                float fadingInVoltage = crossfade(0.f, inVoltages[section][channel], rampGenerators[section][channel].rampVoltage);
+                float_4 fadingInVoltages = inVoltages * rampGenerators[section][currentChannel].rampVoltages;
+                float_4 fadingOutVoltages = inVoltages - fadingInVoltages;
 
-                outputs[OUTPUT_OUT_1A + section].setVoltage(rollResults[section][channel] != fortuna::ROLL_TAILS ?
-                    fadingInVoltage : fadingOutVoltage, channel);
+                float_4 tails = rollResults[section][currentChannel] == static_cast<float>(fortuna::ROLL_TAILS);
 
-                outputs[OUTPUT_OUT_1B + section].setVoltage(rollResults[section][channel] == fortuna::ROLL_TAILS ?
-                    fadingInVoltage : fadingOutVoltage, channel);
+                outputs[OUTPUT_OUT_1A + section].setVoltageSimd(simd::ifelse(tails, fadingOutVoltages, fadingInVoltages), channel);
+                outputs[OUTPUT_OUT_1B + section].setVoltageSimd(simd::ifelse(tails, fadingInVoltages, fadingOutVoltages), channel);
             }
 
             if (outputsConnected[section]) {
@@ -160,7 +178,7 @@ struct Fortuna : SanguineModule {
                 lights[currentLight + 1].setBrightnessSmooth(lightValueB, sampleTime);
 
                 currentLight = LIGHTS_PROBABILITY + section * 2;
-                float rescaledLight = rescale(cvVoltages[section][ledsChannel], 0.f, 5.f, 0.f, 1.f);
+                float rescaledLight = rescale(cvVoltages[section][ledsChannel >> 2][ledsChannel & 3], 0.f, 5.f, 0.f, 1.f);
                 lights[currentLight + 1].setBrightnessSmooth(-rescaledLight, sampleTime);
                 lights[currentLight].setBrightnessSmooth(rescaledLight, sampleTime);
 
@@ -173,11 +191,43 @@ struct Fortuna : SanguineModule {
         }
     }
 
+    void rollCoins(const int section, const int channel, const int triggeredLanes, const float paramThreshold,
+        const float rampDuration) {
+        const int currentChannel = channel >> 2;
+
+        float_4 thresholds = simd::clamp(paramThreshold + cvVoltages[section][currentChannel] / 5.f, 0.f, 1.f);
+        float_4 lastRollResults = rollResults[section][currentChannel];
+
+        for (int lane = 0; lane < 4; ++lane) {
+            if (triggeredLanes & (1 << lane)) {
+                fortuna::RollResults rollResult = ldexpf(pcgRng(), -32) >= thresholds[lane] ?
+                    fortuna::ROLL_HEADS : fortuna::ROLL_TAILS;
+                if (rollModes[section] == fortuna::ROLL_TOGGLE) {
+                    rollResult = static_cast<fortuna::RollResults>(static_cast<int>(lastRollResults[lane]) ^ rollResult);
+                }
+                rollResults[section][currentChannel][lane] = rollResult;
+            }
+        }
+
+        rampGenerators[section][currentChannel].trigger(rollResults[section][currentChannel] != lastRollResults,
+            rampDuration);
+    }
+
+    void setSeed(const uint64_t newSeed) {
+        rngSeed = newSeed;
+        pcgRng = pcg32(rngSeed);
+    }
+
+    void requestSeed(const uint64_t newSeed) {
+        pendingSeed = newSeed;
+        bHavePendingSeed.store(true, std::memory_order_release);
+    }
+
     void onReset() override {
         for (int section = 0; section < kMaxModuleSections; ++section) {
             params[PARAM_ROLL_MODE_1 + section].setValue(0);
-            for (int channel = 0; channel < PORT_MAX_CHANNELS; ++channel) {
-                lastRollResults[section][channel] = fortuna::ROLL_HEADS;
+            for (int channel = 0; channel < PORT_MAX_CHANNELS / 4; ++channel) {
+                rollResults[section][channel] = fortuna::ROLL_HEADS;
             }
         }
     }
@@ -217,6 +267,8 @@ struct Fortuna : SanguineModule {
         json_t* rootJ = SanguineModule::dataToJson();
 
         setJsonInt(rootJ, "ledsChannel", ledsChannel);
+        setJsonInt(rootJ, "rngSeed", static_cast<json_int_t>(rngSeed));
+        setJsonInt(rootJ, "rngSeedModuleId", id);
 
         return rootJ;
     }
@@ -229,6 +281,14 @@ struct Fortuna : SanguineModule {
         if (getJsonInt(rootJ, "ledsChannel", intValue)) {
             ledsChannel = intValue;
         }
+
+        /* Clones, pasted modules and presets get new ids, so only a module loaded from its own patch matches the id
+           saved with its seed; the others keep the fresh seed they were created with. */
+        json_int_t seedModuleId;
+        if (getJsonInt(rootJ, "rngSeed", intValue) && getJsonInt(rootJ, "rngSeedModuleId", seedModuleId) &&
+            seedModuleId == id) {
+            setSeed(static_cast<uint64_t>(intValue));
+        }
     }
 };
 
@@ -316,6 +376,12 @@ struct FortunaWidget : SanguineModuleWidget {
             [=]() {return module->ledsChannel; },
             [=](int i) {module->ledsChannel = i; }
         ));
+
+        menu->addChild(new MenuSeparator);
+
+        menu->addChild(createMenuItem("New random seed", "",
+            [=]() {module->requestSeed(random::u64()); }
+        ));
     }
 };
 
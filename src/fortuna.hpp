@@ -1,5 +1,7 @@
 #pragma once
 
+using simd::float_4;
+
 namespace fortuna {
     enum RollModes {
         ROLL_DIRECT,
@@ -10,4 +12,23 @@ namespace fortuna {
         ROLL_HEADS,
         ROLL_TAILS
     };
-}
\ No newline at end of file
+
+    // Crossfade ramps for four channels: triggered lanes rise from 0 to 1 over the given duration.
+    struct RampGenerator4 {
+        float_4 rampVoltages = 1.f;
+        float_4 rampSlopes = 0.f;
+
+        void trigger(const float_4 triggeredLanes, const float duration) {
+            if (duration > 0.f) {
+                rampVoltages = simd::ifelse(triggeredLanes, 0.f, rampVoltages);
+                rampSlopes = simd::ifelse(triggeredLanes, 1.f / duration, rampSlopes);
+            } else {
+                rampVoltages = simd::ifelse(triggeredLanes, 1.f, rampVoltages);
+            }
+        }
+
+        void process(const float sampleTime) {
+            rampVoltages = simd::fmin(rampVoltages + rampSlopes * sampleTime, 1.f);
+        }
+    };
+}
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <type_traits>
+
+namespace kernelTables {
+    /* Lookup table of process kernels specialized on a connection bitmask.
+       KernelFor<Mask>::kernel() must return the kernel for that mask; the table is filled at
+       compile time, from Count - 1 down to 0, so modules can pick a kernel in onPortChange. */
+    template <typename Kernel, int Count, template <int> class KernelFor>
+    struct KernelTable {
+        Kernel kernels[Count];
+
+        KernelTable() {
+            fill(std::integral_constant<int, Count - 1>());
+        }
+
+        template <int ConnectionMask>
+        void fill(std::integral_constant<int, ConnectionMask>) {
+            kernels[ConnectionMask] = KernelFor<ConnectionMask>::kernel();
+            fill(std::integral_constant<int, ConnectionMask - 1>());
+        }
+
+        void fill(std::integral_constant<int, -1>) {}
+    };
+}
@@ -5,6 +5,8 @@
 #include "kitsune.hpp"
 #ifndef METAMODULE
 #include "denki.hpp"
+
+#include "kerneltable.hpp"
 #endif
 
 using simd::float_4;
@@ -63,11 +65,30 @@ struct Kitsune : SanguineModule {
 #ifndef METAMODULE
 	bool bHaveExpander = false;
 
-	Denki* denkiExpander = nullptr;
+	denki::ControlsMessage denkiMessages[2];
+
+	enum ConnectionBits {
+		CONNECTION_EXPANDER = 1 << 0,
+		CONNECTIONS_COUNT = 1 << 1
+	};
+
+	typedef void (Kitsune::* ProcessKernel)(const ProcessArgs& args);
+
+	/* The expander selects a specialized kernel, so the section loop doesn't test it.
+	   No port changes the work a section does, so only the expander keys the kernels. */
+	template <int ConnectionMask>
+	struct ConnectedKernel {
+		static ProcessKernel kernel() { return &Kitsune::processConnected<ConnectionMask>; }
+	};
+
+	ProcessKernel processKernel = &Kitsune::processConnected<0>;
 #endif
 
 	bool inputsConnected[kitsune::kMaxSections] = {};
 
+	// Input read by each section; only changes when a cable or the normalling mode does.
+	int channelSources[kitsune::kMaxSections] = { 0, 1, 2, 3 };
+
 	kitsune::NormalledModes normalledMode = kitsune::NORMAL_SMART;
 
 	Kitsune() {
@@ -84,97 +105,87 @@ struct Kitsune : SanguineModule {
 
 		configSwitch(PARAM_NORMALLING_MODE, 0.f, 1.f, 1.f, "Input normalling", kitsune::normallingModes);
 
+#ifndef METAMODULE
+		rightExpander.producerMessage = &denkiMessages[0];
+		rightExpander.consumerMessage = &denkiMessages[1];
+#endif
+
 		lightsDivider.setDivision(kLightsFrequency);
 	}
 
 #ifndef METAMODULE
 	void process(const ProcessArgs& args) override {
-		bool bIsLightsTurn = lightsDivider.process();
-
-		normalledMode = kitsune::NormalledModes(params[PARAM_NORMALLING_MODE].getValue());
+		checkNormalledMode();
 
-		int channelSources[kitsune::kMaxSections] = { 0, 1, 2, 3 };
-		int lastChannelSource = -1;
+		(this->*processKernel)(args);
+	}
 
-		if (!bHaveExpander) {
-			if (normalledMode == kitsune::NORMAL_SMART) {
-				for (int section = 0; section < kitsune::kMaxSections; ++section) {
-					assignNormalledInputs(section, channelSources, lastChannelSource);
-					processSection(section, channelSources);
-				}
-			} else {
-				for (int section = 0; section < kitsune::kMaxSections; ++section) {
-					processSection(section, channelSources);
-				}
-			}
-			if (bIsLightsTurn) {
-				const float sampleTime = kLightsFrequency * args.sampleTime;
+	template <int ConnectionMask>
+	void processConnected(const ProcessArgs& args) {
+		const bool bExpanderConnected = ConnectionMask & CONNECTION_EXPANDER;
 
-				lights[LIGHT_EXPANDER].setBrightnessSmooth(bHaveExpander * kSanguineButtonLightValue, sampleTime);
+		bool bIsLightsTurn = lightsDivider.process();
 
-				for (int section = 0; section < kitsune::kMaxSections; ++section) {
-					setNormalledLights(section, channelSources, sampleTime);
+		const denki::ControlsMessage* controlsMessage = nullptr;
+		if (bExpanderConnected) {
+			controlsMessage = static_cast<denki::ControlsMessage*>(rightExpander.consumerMessage);
+		}
 
-					if (channelCounts[section] == 1) {
-						setMonoLights(section, sampleTime);
-					} else {
-						setPolyLights(section, sampleTime);
-					}
-				}
+		if (getSectionsMono()) {
+			if (bExpanderConnected) {
+				processSectionsPackedExpander(controlsMessage);
+			} else {
+				processSectionsPacked();
 			}
 		} else {
-			if (normalledMode == kitsune::NORMAL_SMART) {
-				for (int section = 0; section < kitsune::kMaxSections; ++section) {
-					assignNormalledInputs(section, channelSources, lastChannelSource);
-					processSectionExpander(section, channelSources);
-				}
-			} else {
-				for (int section = 0; section < kitsune::kMaxSections; ++section) {
-					processSectionExpander(section, channelSources);
+			for (int section = 0; section < kitsune::kMaxSections; ++section) {
+				if (bExpanderConnected) {
+					processSectionExpander(section, controlsMessage);
+				} else {
+					processSection(section);
 				}
 			}
+		}
 
-			if (bIsLightsTurn) {
-				const float sampleTime = kLightsFrequency * args.sampleTime;
+		if (bIsLightsTurn) {
+			const float sampleTime = kLightsFrequency * args.sampleTime;
 
-				lights[LIGHT_EXPANDER].setBrightnessSmooth(bHaveExpander * kSanguineButtonLightValue, sampleTime);
+			lights[LIGHT_EXPANDER].setBrightnessSmooth(bExpanderConnected * kSanguineButtonLightValue, sampleTime);
 
-				for (int section = 0; section < kitsune::kMaxSections; ++section) {
-					setNormalledLights(section, channelSources, sampleTime);
+			for (int section = 0; section < kitsune::kMaxSections; ++section) {
+				setNormalledLights(section, sampleTime);
 
-					if (channelCounts[section] == 1) {
-						setMonoLightsExpander(section, sampleTime);
-					} else {
-						setPolyLightsExpander(section, sampleTime);
-					}
+				if (channelCounts[section] == 1) {
+					setMonoLights(section, sampleTime);
+				} else {
+					setPolyLights(section, sampleTime);
 				}
 			}
+
+			if (bExpanderConnected) {
+				sendDenkiStatus();
+			}
 		}
 	}
 #else
 	void process(const ProcessArgs& args) override {
 		bool bIsLightsTurn = lightsDivider.process();
 
-		normalledMode = kitsune::NormalledModes(params[PARAM_NORMALLING_MODE].getValue());
-
-		int channelSources[kitsune::kMaxSections] = { 0, 1, 2, 3 };
-		int lastChannelSource = -1;
+		checkNormalledMode();
 
-		if (normalledMode == kitsune::NORMAL_SMART) {
-			for (int section = 0; section < kitsune::kMaxSections; ++section) {
-				assignNormalledInputs(section, channelSources, lastChannelSource);
-				processSection(section, channelSources);
-			}
+		if (getSectionsMono()) {
+			processSectionsPacked();
 		} else {
 			for (int section = 0; section < kitsune::kMaxSections; ++section) {
-				processSection(section, channelSources);
+				processSection(section);
 			}
 		}
+
 		if (bIsLightsTurn) {
 			const float sampleTime = kLightsFrequency * args.sampleTime;
 
 			for (int section = 0; section < kitsune::kMaxSections; ++section) {
-				setNormalledLights(section, channelSources, sampleTime);
+				setNormalledLights(section, sampleTime);
 
 				if (channelCounts[section] == 1) {
 					setMonoLights(section, sampleTime);
@@ -186,7 +197,7 @@ struct Kitsune : SanguineModule {
 	}
 #endif
 
-	void processSection(const int section, int* channelSources) {
+	void processSection(const int section) {
 		Input* input = &inputs[INPUT_VOLTAGE1 + channelSources[section]];
 
 		int inputChannels = input->getChannels();
@@ -212,15 +223,75 @@ struct Kitsune : SanguineModule {
 		outputs[currentOutput].setChannels(channelCounts[section]);
 	}
 
-	void assignNormalledInputs(const int section, int* channelSources, int& lastChannelSource) {
-		if (inputsConnected[section]) {
-			lastChannelSource = section;
-		} else if (lastChannelSource > -1) {
-			channelSources[section] = lastChannelSource;
+	bool getSectionsMono() {
+		for (int section = 0; section < kitsune::kMaxSections; ++section) {
+			if (inputs[INPUT_VOLTAGE1 + channelSources[section]].getChannels() > 1) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	// With every section mono, one float_4 holds all four sections, a lane each.
+	void processSectionsPacked() {
+		float_4 gains;
+		float_4 offsets;
+
+		getPackedKnobs(gains, offsets);
+		setPackedOutputs(gains, offsets);
+	}
+
+	void getPackedKnobs(float_4& gains, float_4& offsets) {
+		for (int section = 0; section < kitsune::kMaxSections; ++section) {
+			gains[section] = params[PARAM_ATTENUATOR1 + section].getValue();
+			offsets[section] = params[PARAM_OFFSET1 + section].getValue();
+		}
+	}
+
+	void setPackedOutputs(const float_4 gains, const float_4 offsets) {
+		float_4 voltages;
+
+		for (int section = 0; section < kitsune::kMaxSections; ++section) {
+			voltages[section] = inputs[INPUT_VOLTAGE1 + channelSources[section]].getVoltage();
+		}
+
+		voltages = simd::clamp(voltages * gains + offsets, -10.f, 10.f);
+
+		for (int section = 0; section < kitsune::kMaxSections; ++section) {
+			channelCounts[section] = 1;
+
+			outputs[OUTPUT_VOLTAGE1 + section].setVoltage(voltages[section]);
+			outputs[OUTPUT_VOLTAGE1 + section].setChannels(1);
+		}
+	}
+
+	void checkNormalledMode() {
+		kitsune::NormalledModes newMode = kitsune::NormalledModes(params[PARAM_NORMALLING_MODE].getValue());
+
+		if (newMode != normalledMode) {
+			normalledMode = newMode;
+			updateChannelSources();
 		}
 	}
 
-	void setNormalledLights(const int section, int* channelSources, const float& sampleTime) {
+	// Smart normalling feeds an unpatched section from the nearest patched section above it.
+	void updateChannelSources() {
+		int lastChannelSource = -1;
+
+		for (int section = 0; section < kitsune::kMaxSections; ++section) {
+			channelSources[section] = section;
+
+			if (normalledMode == kitsune::NORMAL_SMART) {
+				if (inputsConnected[section]) {
+					lastChannelSource = section;
+				} else if (lastChannelSource > -1) {
+					channelSources[section] = lastChannelSource;
+				}
+			}
+		}
+	}
+
+	void setNormalledLights(const int section, const float& sampleTime) {
 		const int currentLight = LIGHT_NORMALLED1 + section * 3;
 
 		RGBLightColor lightColor = kitsune::lightColors[channelSources[section]];
@@ -256,7 +327,7 @@ struct Kitsune : SanguineModule {
 	}
 
 #ifndef METAMODULE
-	void processSectionExpander(const int section, int* channelSources) {
+	void processSectionExpander(const int section, const denki::ControlsMessage* controlsMessage) {
 		Input* input = &inputs[INPUT_VOLTAGE1 + channelSources[section]];
 
 		int inputChannels = input->getChannels();
@@ -273,7 +344,7 @@ struct Kitsune : SanguineModule {
 			float_4 gains = gainKnob;
 			float_4 offsets = offsetKnob;
 
-			applyModulations(section, channel, gains, offsets);
+			applyModulations(section, channel, gains, offsets, controlsMessage);
 
 			/* TODO: make manual and module congruent: either we clip it and state so in the manual
 			   or we remove the clamp. */
@@ -284,88 +355,67 @@ struct Kitsune : SanguineModule {
 		outputs[currentOutput].setChannels(channelCounts[section]);
 	}
 
-	void applyModulations(const int section, const int channel, float_4& gains, float_4& offsets) {
-		if (denkiExpander->getGainConnected(section)) {
-			gains += denkiExpander->getInput(Denki::INPUT_GAIN_CV + section).getVoltageSimd<float_4>(channel) / 5.f;
+	void processSectionsPackedExpander(const denki::ControlsMessage* controlsMessage) {
+		float_4 gains;
+		float_4 offsets;
+
+		getPackedKnobs(gains, offsets);
+
+		for (int section = 0; section < kitsune::kMaxSections; ++section) {
+			if (controlsMessage->gainsConnected[section]) {
+				gains[section] = clamp(gains[section] + controlsMessage->gainVoltages[section][0][0] / 5.f, -2.f, 2.f);
+			}
+			if (controlsMessage->offsetsConnected[section]) {
+				offsets[section] = clamp(offsets[section] + controlsMessage->offsetVoltages[section][0][0] / 5.f,
+					-10.f, 10.f);
+			}
+		}
+
+		setPackedOutputs(gains, offsets);
+	}
+
+	void applyModulations(const int section, const int channel, float_4& gains, float_4& offsets,
+		const denki::ControlsMessage* controlsMessage) {
+		if (controlsMessage->gainsConnected[section]) {
+			gains += controlsMessage->gainVoltages[section][channel >> 2] / 5.f;
 			gains = simd::clamp(gains, -2.f, 2.f);
 		}
-		if (denkiExpander->getOffsetConnected(section)) {
-			offsets += denkiExpander->getInput(Denki::INPUT_OFFSET_CV + section).getVoltageSimd<float_4>(channel) / 5.f;
+		if (controlsMessage->offsetsConnected[section]) {
+			offsets += controlsMessage->offsetVoltages[section][channel >> 2] / 5.f;
 			offsets = simd::clamp(offsets, -10.f, 10.f);
 		}
 	}
 
-	void setMonoLightsExpander(const int section, const float& sampleTime) {
-		setMonoLights(section, sampleTime);
-
-		const int currentExpanderGainLight = Denki::LIGHT_GAIN_CV + section * 3;
-		float cvGainLightValue = denkiExpander->getInput(Denki::INPUT_GAIN_CV + section).getVoltage();
-		float rescaledLight = math::rescale(cvGainLightValue, 0.f, 10.f, 0.f, 1.f);
-		denkiExpander->getLight(currentExpanderGainLight).setBrightnessSmooth(-rescaledLight, sampleTime);
-		denkiExpander->getLight(currentExpanderGainLight + 1).setBrightnessSmooth(rescaledLight, sampleTime);
-		denkiExpander->getLight(currentExpanderGainLight + 2).setBrightnessSmooth(0.f, sampleTime);
-
-		const int currentExpanderOffsetLight = Denki::LIGHT_OFFSET_CV + section * 3;
-		float cvOffsetLightValue = denkiExpander->getInput(Denki::INPUT_OFFSET_CV + section).getVoltage();
-		rescaledLight = math::rescale(cvOffsetLightValue, 0.f, 10.f, 0.f, 1.f);
-		denkiExpander->getLight(currentExpanderOffsetLight).setBrightnessSmooth(-rescaledLight, sampleTime);
-		denkiExpander->getLight(currentExpanderOffsetLight + 1).setBrightnessSmooth(rescaledLight, sampleTime);
-		denkiExpander->getLight(currentExpanderOffsetLight + 2).setBrightnessSmooth(0.f, sampleTime);
-	}
+	void updateProcessKernel() {
+		static const kernelTables::KernelTable<ProcessKernel, CONNECTIONS_COUNT, ConnectedKernel> kernelTable;
 
-	void setPolyLightsExpander(const int section, const float& sampleTime) {
-		const int currentLight = LIGHT_VOLTAGE1 + section * 3;
+		int connectionMask = 0;
+		connectionMask |= bHaveExpander * CONNECTION_EXPANDER;
 
-		float cvGainLightValue = 0.f;
-		float cvOffsetLightValue = 0.f;
+		processKernel = kernelTable.kernels[connectionMask];
+	}
 
-		float* outputVoltages = outputs[OUTPUT_VOLTAGE1 + section].getVoltages();
-		float lightValue = 0;
-		for (int channel = 0; channel < channelCounts[section]; ++channel) {
-			lightValue += outputVoltages[channel];
+	void sendDenkiStatus() {
+		denki::StatusMessage* statusMessage =
+			static_cast<denki::StatusMessage*>(rightExpander.module->leftExpander.producerMessage);
 
-			cvGainLightValue += denkiExpander->getInput(Denki::INPUT_GAIN_CV + section).getVoltage(channel);
-			cvOffsetLightValue += denkiExpander->getInput(Denki::INPUT_OFFSET_CV + section).getVoltage(channel);
+		for (int section = 0; section < kitsune::kMaxSections; ++section) {
+			statusMessage->channelCounts[section] = channelCounts[section];
 		}
-		lightValue /= channelCounts[section];
 
-		float rescaledLight = math::rescale(lightValue, 0.f, 10.f, 0.f, 1.f);
-		lights[currentLight].setBrightnessSmooth(-rescaledLight, sampleTime);
-		lights[currentLight + 1].setBrightnessSmooth(rescaledLight, sampleTime);
-		lights[currentLight + 2].setBrightnessSmooth(lightValue < 0 ? -rescaledLight : rescaledLight, sampleTime);
-
-		const int currentExpanderGainLight = Denki::LIGHT_GAIN_CV + section * 3;
-
-		cvGainLightValue /= channelCounts[section];
-
-		rescaledLight = math::rescale(cvGainLightValue, 0.f, 10.f, 0.f, 1.f);
-
-		denkiExpander->getLight(currentExpanderGainLight).setBrightnessSmooth(-rescaledLight, sampleTime);
-		denkiExpander->getLight(currentExpanderGainLight + 1).setBrightnessSmooth(rescaledLight, sampleTime);
-		denkiExpander->getLight(currentExpanderGainLight + 2).setBrightnessSmooth(cvGainLightValue < 0 ?
-			-rescaledLight : rescaledLight, sampleTime);
-
-		const int currentExpanderOffsetLight = Denki::LIGHT_OFFSET_CV + section * 3;
-		cvOffsetLightValue /= channelCounts[section];
-
-		rescaledLight = math::rescale(cvOffsetLightValue, 0.f, 10.f, 0.f, 1.f);
-
-		denkiExpander->getLight(currentExpanderOffsetLight).setBrightnessSmooth(-rescaledLight, sampleTime);
-		denkiExpander->getLight(currentExpanderOffsetLight + 1).setBrightnessSmooth(rescaledLight, sampleTime);
-		denkiExpander->getLight(currentExpanderOffsetLight + 2).setBrightnessSmooth(cvOffsetLightValue < 0 ?
-			-rescaledLight : rescaledLight, sampleTime);
+		rightExpander.module->leftExpander.requestMessageFlip();
 	}
 
 	void onBypass(const BypassEvent& e) override {
 		if (bHaveExpander) {
-			denkiExpander->getLight(Denki::LIGHT_MASTER_MODULE).setBrightness(0.f);
+			rightExpander.module->getLight(Denki::LIGHT_MASTER_MODULE).setBrightness(0.f);
 		}
 		Module::onBypass(e);
 	}
 
 	void onUnBypass(const UnBypassEvent& e) override {
 		if (bHaveExpander) {
-			denkiExpander->getLight(Denki::LIGHT_MASTER_MODULE).setBrightness(kSanguineButtonLightValue);
+			rightExpander.module->getLight(Denki::LIGHT_MASTER_MODULE).setBrightness(kSanguineButtonLightValue);
 		}
 		Module::onUnBypass(e);
 	}
@@ -375,10 +425,7 @@ struct Kitsune : SanguineModule {
 			Module* rightModule = getRightExpander().module;
 			bHaveExpander = rightModule && rightModule->getModel() == modelDenki &&
 				!rightModule->isBypassed();
-
-			if (bHaveExpander) {
-				denkiExpander = dynamic_cast<Denki*>(rightModule);
-			}
+			updateProcessKernel();
 		}
 	}
 #endif
@@ -386,6 +433,7 @@ struct Kitsune : SanguineModule {
 	void onPortChange(const PortChangeEvent& e) override {
 		if (e.type == Port::INPUT) {
 			inputsConnected[e.portId] = e.connecting;
+			updateChannelSources();
 		}
 	}
 
@@ -404,6 +452,7 @@ struct Kitsune : SanguineModule {
 
 		if (getJsonInt(rootJ, "normalledMode", intValue)) {
 			normalledMode = static_cast<kitsune::NormalledModes>(intValue);
+			updateChannelSources();
 		}
 	}
 
@@ -6,6 +6,69 @@ Manus::Manus() {
     for (int input = 0; input < superSwitches::kMaxSteps; ++input) {
         configInput(INPUT_STEP_1 + input, string::f("Step %d", input + 1));
     }
+
+    leftExpander.producerMessage = &leftStatusMessages[0];
+    leftExpander.consumerMessage = &leftStatusMessages[1];
+
+    rightExpander.producerMessage = &rightStatusMessages[0];
+    rightExpander.consumerMessage = &rightStatusMessages[1];
+
+    lightsDivider.setDivision(kLightsFrequency);
+}
+
+void Manus::process(const ProcessArgs& args) {
+    bool bIsLightsTurn = lightsDivider.process();
+
+    float sampleTime = 0.f;
+
+    if (bIsLightsTurn) {
+        sampleTime = args.sampleTime * kLightsFrequency;
+    }
+
+    Module* gegeenesMaster = getLeftExpander().module;
+
+    if (gegeenesMaster && gegeenesMaster->getModel() == modelSuperSwitch18 && !gegeenesMaster->isBypassed()) {
+        sendControls(gegeenesMaster->rightExpander);
+
+        if (bIsLightsTurn) {
+            setStepLights(LIGHT_STEP_1_LEFT, static_cast<manus::StatusMessage*>(leftExpander.consumerMessage),
+                sampleTime);
+        }
+    }
+
+    Module* hydraMaster = getRightExpander().module;
+
+    if (hydraMaster && hydraMaster->getModel() == modelSuperSwitch81 && !hydraMaster->isBypassed()) {
+        sendControls(hydraMaster->leftExpander);
+
+        if (bIsLightsTurn) {
+            setStepLights(LIGHT_STEP_1_RIGHT, static_cast<manus::StatusMessage*>(rightExpander.consumerMessage),
+                sampleTime);
+        }
+    }
+}
+
+void Manus::sendControls(Expander& masterExpander) {
+    manus::ControlsMessage* controlsMessage = static_cast<manus::ControlsMessage*>(masterExpander.producerMessage);
+
+    for (int step = 0; step < superSwitches::kMaxSteps; step += 4) {
+        controlsMessage->stepVoltages[step >> 2] = float_4(inputs[INPUT_STEP_1 + step].getVoltage(),
+            inputs[INPUT_STEP_1 + step + 1].getVoltage(), inputs[INPUT_STEP_1 + step + 2].getVoltage(),
+            inputs[INPUT_STEP_1 + step + 3].getVoltage());
+    }
+
+    for (int step = 0; step < superSwitches::kMaxSteps; ++step) {
+        controlsMessage->inputsConnected[step] = inputsConnected[step];
+    }
+
+    masterExpander.requestMessageFlip();
+}
+
+void Manus::setStepLights(const int firstLight, const manus::StatusMessage* statusMessage, const float sampleTime) {
+    for (int step = 0; step < superSwitches::kMaxSteps; ++step) {
+        bool bLightActive = step < statusMessage->stepCount;
+        lights[firstLight + step].setBrightnessSmooth(bLightActive * kSanguineButtonLightValue, sampleTime);
+    }
 }
 
 void Manus::onExpanderChange(const ExpanderChangeEvent& e) {
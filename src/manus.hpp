@@ -6,6 +6,25 @@
 
 #include "switches.hpp"
 
+using simd::float_4;
+
+namespace manus {
+    /* Messages are double-buffered by the engine: step triggers reach the
+       switch one sample after Manus reads them. */
+
+    // Manus to Gegenees or Hydra.
+    struct ControlsMessage {
+        float_4 stepVoltages[superSwitches::kMaxSteps / 4] = {};
+
+        bool inputsConnected[superSwitches::kMaxSteps] = {};
+    };
+
+    // Gegenees or Hydra to Manus.
+    struct StatusMessage {
+        int stepCount = 0;
+    };
+}
+
 struct Manus : SanguineModule {
 
     enum ParamIds {
@@ -53,6 +72,8 @@ struct Manus : SanguineModule {
 
     Manus();
 
+    void process(const ProcessArgs& args) override;
+
     void onExpanderChange(const ExpanderChangeEvent& e) override;
     void onPortChange(const PortChangeEvent& e) override;
 
@@ -65,5 +86,15 @@ struct Manus : SanguineModule {
     }
 
 private:
+    static const int kLightsFrequency = 16;
+
     bool inputsConnected[superSwitches::kMaxSteps] = {};
+
+    dsp::ClockDivider lightsDivider;
+
+    manus::StatusMessage leftStatusMessages[2];
+    manus::StatusMessage rightStatusMessages[2];
+
+    void sendControls(Expander& masterExpander);
+    void setStepLights(const int firstLight, const manus::StatusMessage* statusMessage, const float sampleTime);
 };
\ No newline at end of file
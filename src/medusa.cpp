@@ -34,6 +34,13 @@ struct Medusa : SanguineModule {
 	bool inputsConnected[medusa::kMaxPorts] = {};
 	bool outputsConnected[medusa::kMaxPorts] = {};
 
+	// Routing table, rebuilt when a cable changes: the input each patched output copies, in port order.
+	int routedOutputs[medusa::kMaxPorts] = {};
+	int routedSources[medusa::kMaxPorts] = {};
+	int routeCount = 0;
+
+	int portPalettes[medusa::kMaxPorts] = {};
+
 	Medusa() {
 		config(PARAMS_COUNT, INPUTS_COUNT, OUTPUTS_COUNT, LIGHTS_COUNT);
 
@@ -43,22 +50,47 @@ struct Medusa : SanguineModule {
 		}
 
 		lightsDivider.setDivision(kLightsFrequency);
+
+		updateRouting();
 	}
 
 	void process(const ProcessArgs& args) override {
-		int channelCount = 0;
-		int activePort = 0;
+		bool bIsLightsTurn = lightsDivider.process();
+
+		for (int route = 0; route < routeCount; ++route) {
+			Input& input = inputs[INPUT_VOLTAGE + routedSources[route]];
+			Output& output = outputs[OUTPUT_VOLTAGE + routedOutputs[route]];
+
+			const int channelCount = input.getChannels();
+
+			for (int channel = 0; channel < channelCount; channel += 4) {
+				output.setVoltageSimd(input.getVoltageSimd<float_4>(channel), channel);
+			}
+
+			output.setChannels(channelCount);
+		}
 
-		int portPalettes[medusa::kMaxPorts];
+		if (bIsLightsTurn) {
+			const float sampleTime = kLightsFrequency * args.sampleTime;
 
+			for (int port = 0; port < medusa::kMaxPorts; ++port) {
+				int currentLight = LIGHT_NORMALLED_PORT + port * 3;
+				lights[currentLight].setBrightnessSmooth(medusa::paletteLights[portPalettes[port]].red, sampleTime);
+				lights[currentLight + 1].setBrightnessSmooth(medusa::paletteLights[portPalettes[port]].green, sampleTime);
+				lights[currentLight + 2].setBrightnessSmooth(medusa::paletteLights[portPalettes[port]].blue, sampleTime);
+			}
+		}
+	}
+
+	void updateRouting() {
+		int sourcePort = -1;
 		int lastPalette = 5;
 
-		bool bIsLightsTurn = lightsDivider.process();
+		routeCount = 0;
 
 		for (int port = 0; port < medusa::kMaxPorts; ++port) {
 			if (inputsConnected[port]) {
-				channelCount = inputs[INPUT_VOLTAGE + port].getChannels();
-				activePort = port;
+				sourcePort = port;
 
 				++lastPalette;
 
@@ -70,23 +102,13 @@ struct Medusa : SanguineModule {
 			portPalettes[port] = lastPalette;
 
 			if (outputsConnected[port]) {
-				for (int channel = 0; channel < channelCount; channel += 4) {
-					float_4 voltages = inputs[activePort].getVoltageSimd<float_4>(channel);
-					outputs[OUTPUT_VOLTAGE + port].setVoltageSimd(voltages, channel);
+				if (sourcePort > -1) {
+					routedOutputs[routeCount] = port;
+					routedSources[routeCount] = sourcePort;
+					++routeCount;
+				} else {
+					outputs[OUTPUT_VOLTAGE + port].setChannels(0);
 				}
-
-				outputs[port].setChannels(channelCount);
-			}
-		}
-
-		if (bIsLightsTurn) {
-			const float sampleTime = kLightsFrequency * args.sampleTime;
-
-			for (int port = 0; port < medusa::kMaxPorts; ++port) {
-				int currentLight = LIGHT_NORMALLED_PORT + port * 3;
-				lights[currentLight].setBrightnessSmooth(medusa::paletteLights[portPalettes[port]].red, sampleTime);
-				lights[currentLight + 1].setBrightnessSmooth(medusa::paletteLights[portPalettes[port]].green, sampleTime);
-				lights[currentLight + 2].setBrightnessSmooth(medusa::paletteLights[portPalettes[port]].blue, sampleTime);
 			}
 		}
 	}
@@ -97,6 +119,8 @@ struct Medusa : SanguineModule {
 		} else {
 			outputsConnected[e.portId] = e.connecting;
 		}
+
+		updateRouting();
 	}
 };
 
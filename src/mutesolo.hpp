@@ -0,0 +1,220 @@
+#pragma once
+
+namespace muteSolo {
+    static const int kChannels = 16;
+    static const int kAllChannels = (1 << kChannels) - 1;
+
+    // Bits first to last - 1 set.
+    inline int getChannelRange(const int first, const int last) {
+        return ((1 << last) - 1) & ~((1 << first) - 1);
+    }
+
+    /* Alchemist mute and solo state, one bit per channel, resolved on the lights turn.
+       Crucible's all, exclusive and CV controls apply channel by channel in order, so a button press can change
+       how the channels after it resolve; channels are resolved as runs between those points, a run at a time. */
+    struct MuteSoloEngine {
+        int mutedChannels = 0;
+        int soloedChannels = 0;
+        int soloCount = 0;
+
+        int exclusiveMuteChannel = -1;
+        int exclusiveSoloChannel = -1;
+
+        bool bLastAllMuted = false;
+        bool bLastAllSoloed = false;
+
+        // Crucible controls.
+        bool bMuteAllEnabled = false;
+        bool bSoloAllEnabled = false;
+
+        bool bMuteExclusiveEnabled = false;
+        bool bSoloExclusiveEnabled = false;
+
+        bool bHaveExpanderMuteCv = false;
+        bool bHaveExpanderSoloCv = false;
+
+        bool bLastHaveExpanderMuteCv = false;
+        bool bLastHaveExpanderSoloCv = false;
+
+        bool bClearCrucibleMuteAll = false;
+        bool bClearCrucibleSoloAll = false;
+
+        // Channels that reach the mix.
+        int getActiveChannels() const {
+            return ~mutedChannels & (soloCount == 0 ? kAllChannels : soloedChannels) & kAllChannels;
+        }
+
+        // For mutes and solos set from outside a resolve, as when they are loaded from a patch.
+        void updateSoloCount() {
+            soloCount = __builtin_popcount(soloedChannels);
+        }
+
+        // Without Crucible, channels don't affect each other.
+        void resolve(const int pressedMutes, const int pressedSolos) {
+            mutedChannels ^= pressedMutes;
+            soloedChannels &= ~pressedMutes;
+
+            soloedChannels ^= pressedSolos;
+            mutedChannels &= ~pressedSolos;
+
+            mutedChannels &= ~soloedChannels;
+            soloCount = __builtin_popcount(soloedChannels);
+        }
+
+        // cvMutes and cvSolos have bit n set when channel n of the Crucible CV is high; they apply below channelCount.
+        void resolveCrucible(const int pressedMutes, const int pressedSolos, const int cvMutes, const int cvSolos,
+            const int channelCount) {
+            bool bIgnoreMuteAll = false;
+            bool bIgnoreSoloAll = false;
+
+            soloCount = 0;
+
+            const int cvChannels = (1 << channelCount) - 1;
+
+            int runStarts = pressedMutes | pressedSolos;
+            if ((bHaveExpanderMuteCv || bHaveExpanderSoloCv) && channelCount < kChannels) {
+                runStarts |= 1 << channelCount;
+            }
+
+            int runStart = 0;
+            while (runStart < kChannels) {
+                const int laterStarts = runStarts & ~getChannelRange(0, runStart + 1);
+                const int runEnd = laterStarts ? __builtin_ctz(laterStarts) : kChannels;
+                const int run = getChannelRange(runStart, runEnd);
+                const int startBit = 1 << runStart;
+
+                // The first channel of a run takes its buttons and CV in the same order as the panel.
+                if (pressedMutes & startBit) {
+                    pressMute(runStart, bIgnoreMuteAll, bIgnoreSoloAll);
+                }
+                applyMuteCv(cvMutes, startBit & cvChannels);
+                if (pressedSolos & startBit) {
+                    pressSolo(runStart, bIgnoreMuteAll, bIgnoreSoloAll);
+                }
+                applySoloCv(cvSolos, startBit & cvChannels);
+
+                applyMuteCv(cvMutes, run & ~startBit & cvChannels);
+                applySoloCv(cvSolos, run & ~startBit & cvChannels);
+
+                if (!bMuteExclusiveEnabled && !bIgnoreMuteAll && ((bLastAllMuted != bMuteAllEnabled) |
+                    (bLastHaveExpanderMuteCv != bHaveExpanderMuteCv))) {
+                    mutedChannels = bMuteAllEnabled ? mutedChannels | run : mutedChannels & ~run;
+                }
+
+                if (!bSoloExclusiveEnabled && !bIgnoreSoloAll && ((bLastAllSoloed != bSoloAllEnabled) |
+                    (bLastHaveExpanderSoloCv != bHaveExpanderSoloCv))) {
+                    soloedChannels = bSoloAllEnabled ? soloedChannels | run : soloedChannels & ~run;
+                }
+
+                if (bMuteExclusiveEnabled && exclusiveMuteChannel >= 0) {
+                    mutedChannels &= ~(run & ~(1 << exclusiveMuteChannel));
+                }
+
+                if (bSoloExclusiveEnabled && exclusiveSoloChannel >= 0) {
+                    soloedChannels &= ~(run & ~(1 << exclusiveSoloChannel));
+                }
+
+                soloCount += __builtin_popcount(soloedChannels & run);
+                mutedChannels &= ~(soloedChannels & run);
+
+                runStart = runEnd;
+            }
+
+            setCrucibleValues();
+        }
+
+        void setPreviousExpanderVoltages() {
+            bLastHaveExpanderMuteCv = bHaveExpanderMuteCv;
+            bLastHaveExpanderSoloCv = bHaveExpanderSoloCv;
+        }
+
+    private:
+        void pressMute(const int channel, bool& bIgnoreMuteAll, bool& bIgnoreSoloAll) {
+            const int channelBit = 1 << channel;
+
+            mutedChannels ^= channelBit;
+            soloedChannels &= ~channelBit;
+
+            if ((bMuteAllEnabled && bLastAllMuted) && !(mutedChannels & channelBit)) {
+                bMuteAllEnabled = false;
+                bClearCrucibleMuteAll = true;
+                bIgnoreMuteAll = true;
+            }
+
+            if (bSoloAllEnabled && bLastAllSoloed) {
+                bSoloAllEnabled = false;
+                bClearCrucibleSoloAll = true;
+                bIgnoreSoloAll = true;
+            }
+
+            exclusiveMuteChannel = exclusiveMuteChannel != channel ? channel : -1;
+        }
+
+        void pressSolo(const int channel, bool& bIgnoreMuteAll, bool& bIgnoreSoloAll) {
+            const int channelBit = 1 << channel;
+
+            soloedChannels ^= channelBit;
+            mutedChannels &= ~channelBit;
+
+            if (bMuteAllEnabled && bLastAllMuted) {
+                bMuteAllEnabled = false;
+                bClearCrucibleMuteAll = true;
+                bIgnoreMuteAll = true;
+            }
+
+            if ((bSoloAllEnabled && bLastAllSoloed) && !(soloedChannels & channelBit)) {
+                bSoloAllEnabled = false;
+                bClearCrucibleSoloAll = true;
+                bIgnoreSoloAll = true;
+            }
+
+            exclusiveSoloChannel = exclusiveSoloChannel != channel ? channel : -1;
+        }
+
+        void applyMuteCv(const int cvMutes, const int channels) {
+            if (bHaveExpanderMuteCv && channels) {
+                mutedChannels = (mutedChannels & ~channels) | (cvMutes & channels);
+                exclusiveMuteChannel = -1;
+            }
+        }
+
+        void applySoloCv(const int cvSolos, const int channels) {
+            if (bHaveExpanderSoloCv && channels) {
+                soloedChannels = (soloedChannels & ~channels) | (cvSolos & channels);
+                exclusiveSoloChannel = -1;
+            }
+        }
+
+        void setCrucibleValues() {
+            if (bLastAllMuted != bMuteAllEnabled) {
+                bLastAllMuted = bMuteAllEnabled;
+
+                if (bMuteAllEnabled) {
+                    mutedChannels = kAllChannels;
+                    soloedChannels = 0;
+                }
+
+                if (bSoloAllEnabled) {
+                    bSoloAllEnabled = false;
+                    bLastAllSoloed = false;
+                    bClearCrucibleSoloAll = true;
+                }
+            }
+
+            if (bLastAllSoloed != bSoloAllEnabled) {
+                bLastAllSoloed = bSoloAllEnabled;
+
+                if (bSoloAllEnabled) {
+                    soloedChannels = kAllChannels;
+                    mutedChannels = 0;
+                }
+
+                if (bMuteAllEnabled) {
+                    bMuteAllEnabled = false;
+                    bLastAllMuted = false;
+                    bClearCrucibleMuteAll = true;
+                }
+            }
+        }
+    };
+}
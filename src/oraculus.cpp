@@ -9,6 +9,8 @@
 #include "pcg_random.hpp"
 #pragma GCC diagnostic pop
 
+#include "controlscanner.hpp"
+
 struct Oraculus : SanguineModule {
 
 	enum ParamIds {
@@ -32,6 +34,8 @@ struct Oraculus : SanguineModule {
 
 	enum OutputIds {
 		OUTPUT_MONOPHONIC,
+		OUTPUT_FAN_OUT_1,
+		OUTPUT_FAN_OUT_2,
 		OUTPUTS_COUNT
 	};
 
@@ -45,24 +49,30 @@ struct Oraculus : SanguineModule {
 
 	dsp::ClockDivider lightsDivider;
 
-	dsp::BooleanTrigger btDecrease;
-	dsp::BooleanTrigger btIncrease;
-	dsp::BooleanTrigger btRandom;
-	dsp::BooleanTrigger btReset;
+	// Buttons are the first params, so bit n of a scan is param n; they are scanned on the lights turn.
+	controlScanners::ButtonScanner<PARAM_NO_REPEATS> buttons;
 	dsp::SchmittTrigger stInputDecrease;
 	dsp::SchmittTrigger stInputIncrease;
 	dsp::SchmittTrigger stInputRandom;
 	dsp::SchmittTrigger stInputReset;
 
+	static const int kFanOutputs = 2;
+
 	int channelCount = 0;
 	int finalChannel = -1;
 	int selectedChannel = 0;
+	// Channel offset from the CV input, updated on the lights turn.
+	int cvChannelOffset = 0;
+	// Channels the fan-out outputs are ahead of the monophonic output.
+	int fanOutOffsets[kFanOutputs] = { 1, 2 };
+	// Consecutive channels carried by each fan-out output.
+	int fanOutChannels[kFanOutputs] = { 1, 1 };
 
 	bool bCvConnected = false;
 	bool bDecreaseConnected = false;
 	bool bIncreaseConnected = false;
 	bool bNoRepeats = false;
-	bool bOutputConnected = false;
+	bool outputsConnected[OUTPUTS_COUNT] = {};
 	bool bRandomConnected = false;
 	bool bResetConnected = false;
 
@@ -89,6 +99,8 @@ struct Oraculus : SanguineModule {
 		configInput(INPUT_CV_OFFSET, "Channel select offset CV");
 
 		configOutput(OUTPUT_MONOPHONIC, "Monophonic");
+		configOutput(OUTPUT_FAN_OUT_1, "Fan-out 1");
+		configOutput(OUTPUT_FAN_OUT_2, "Fan-out 2");
 
 		pcgRng = pcg32(static_cast<int>(std::round(system::getUnixTime())));
 
@@ -98,8 +110,20 @@ struct Oraculus : SanguineModule {
 	void process(const ProcessArgs& args) override {
 		channelCount = inputs[INPUT_POLYPHONIC].getChannels();
 
+		bool bIsLightsTurn = lightsDivider.process();
+
+		int pressedButtons = 0;
+
+		if (bIsLightsTurn) {
+			pressedButtons = buttons.scan(params, PARAM_INCREASE);
+
+			bNoRepeats = params[PARAM_NO_REPEATS].getValue();
+
+			cvChannelOffset = std::floor(clamp(inputs[INPUT_CV_OFFSET].getVoltage(), -10.f, 10.f) * (channelCount / 10.f));
+		}
+
 		if ((bResetConnected && stInputReset.process(inputs[INPUT_RESET].getVoltage())) ||
-			btReset.process(params[PARAM_RESET].getValue())) {
+			(pressedButtons & (1 << PARAM_RESET))) {
 			doResetTrigger();
 		}
 
@@ -111,50 +135,60 @@ struct Oraculus : SanguineModule {
 			}
 
 			if ((bIncreaseConnected && stInputIncrease.process(inputs[INPUT_INCREASE].getVoltage()))
-				|| btIncrease.process(params[PARAM_INCREASE].getValue())) {
+				|| (pressedButtons & (1 << PARAM_INCREASE))) {
 				doIncreaseTrigger();
 			}
 
 			if ((bDecreaseConnected && stInputDecrease.process(inputs[INPUT_DECREASE].getVoltage()))
-				|| btDecrease.process(params[PARAM_DECREASE].getValue())) {
+				|| (pressedButtons & (1 << PARAM_DECREASE))) {
 				doDecreaseTrigger();
 			}
 
 			if ((bRandomConnected && stInputRandom.process(inputs[INPUT_RANDOM].getVoltage()))
-				|| btRandom.process(params[PARAM_RANDOM].getValue())) {
+				|| (pressedButtons & (1 << PARAM_RANDOM))) {
 				doRandomTrigger();
 			}
 
 			finalChannel = selectedChannel;
 			if (bCvConnected && channelCount > 1) {
-				float cv = inputs[INPUT_CV_OFFSET].getVoltage();
-				int channelOffset = std::floor(cv * (channelCount / 10.f));
-				finalChannel = selectedChannel + channelOffset;
-				if (finalChannel < 0) {
-					finalChannel = channelCount + channelOffset;
-				}
-				if (finalChannel >= channelCount) {
-					finalChannel = channelOffset - (channelCount - selectedChannel);
-				}
+				finalChannel = wrapChannel(selectedChannel + cvChannelOffset);
 			}
 
-			if (bOutputConnected) {
+			if (outputsConnected[OUTPUT_MONOPHONIC]) {
 				outputs[OUTPUT_MONOPHONIC].setVoltage(inputs[INPUT_POLYPHONIC].getVoltage(finalChannel));
 				outputs[OUTPUT_MONOPHONIC].setChannels(1);
 			}
+
+			for (int fanOutput = 0; fanOutput < kFanOutputs; ++fanOutput) {
+				const int currentOutput = OUTPUT_FAN_OUT_1 + fanOutput;
+				if (outputsConnected[currentOutput]) {
+					const int fanChannels = std::min(fanOutChannels[fanOutput], channelCount);
+					int channel = wrapChannel(finalChannel + fanOutOffsets[fanOutput]);
+					for (int fanChannel = 0; fanChannel < fanChannels; ++fanChannel) {
+						outputs[currentOutput].setVoltage(inputs[INPUT_POLYPHONIC].getVoltage(channel), fanChannel);
+						channel = channel + 1 < channelCount ? channel + 1 : 0;
+					}
+					outputs[currentOutput].setChannels(fanChannels);
+				}
+			}
 		} else {
-			if (bOutputConnected) {
-				outputs[OUTPUT_MONOPHONIC].setChannels(0);
+			for (int output = 0; output < OUTPUTS_COUNT; ++output) {
+				if (outputsConnected[output]) {
+					outputs[output].setChannels(0);
+				}
 			}
 		}
 
-		bNoRepeats = params[PARAM_NO_REPEATS].getValue();
-
-		if (lightsDivider.process()) {
+		if (bIsLightsTurn) {
 			updateLights(args);
 		}
 	}
 
+	int wrapChannel(const int channel) {
+		int wrappedChannel = channel % channelCount;
+		return wrappedChannel < 0 ? wrappedChannel + channelCount : wrappedChannel;
+	}
+
 	void doDecreaseTrigger() {
 		selectedChannel = ((selectedChannel - 1) + channelCount) % channelCount;
 	};
@@ -236,10 +270,49 @@ struct Oraculus : SanguineModule {
 			break;
 
 		case Port::OUTPUT:
-			bOutputConnected = e.connecting;
+			outputsConnected[e.portId] = e.connecting;
 			break;
 		}
 	}
+
+	json_t* dataToJson() override {
+		json_t* rootJ = SanguineModule::dataToJson();
+
+		json_t* fanOutOffsetsJ = json_array();
+		for (int fanOutput = 0; fanOutput < kFanOutputs; ++fanOutput) {
+			json_array_append_new(fanOutOffsetsJ, json_integer(fanOutOffsets[fanOutput]));
+		}
+		json_object_set_new(rootJ, "fanOutOffsets", fanOutOffsetsJ);
+
+		json_t* fanOutChannelsJ = json_array();
+		for (int fanOutput = 0; fanOutput < kFanOutputs; ++fanOutput) {
+			json_array_append_new(fanOutChannelsJ, json_integer(fanOutChannels[fanOutput]));
+		}
+		json_object_set_new(rootJ, "fanOutChannels", fanOutChannelsJ);
+
+		return rootJ;
+	}
+
+	void dataFromJson(json_t* rootJ) override {
+		SanguineModule::dataFromJson(rootJ);
+
+		json_t* fanOutOffsetsJ = json_object_get(rootJ, "fanOutOffsets");
+		size_t idx;
+		json_t* offsetJ;
+		json_array_foreach(fanOutOffsetsJ, idx, offsetJ) {
+			if (idx < kFanOutputs) {
+				fanOutOffsets[idx] = clamp(static_cast<int>(json_integer_value(offsetJ)), 1, PORT_MAX_CHANNELS - 1);
+			}
+		}
+
+		json_t* fanOutChannelsJ = json_object_get(rootJ, "fanOutChannels");
+		json_t* channelsJ;
+		json_array_foreach(fanOutChannelsJ, idx, channelsJ) {
+			if (idx < kFanOutputs) {
+				fanOutChannels[idx] = clamp(static_cast<int>(json_integer_value(channelsJ)), 1, PORT_MAX_CHANNELS);
+			}
+		}
+	}
 };
 
 struct OraculusWidget : SanguineModuleWidget {
@@ -265,6 +338,8 @@ struct OraculusWidget : SanguineModuleWidget {
 		addInput(createInputCentered<BananutPurple>(millimetersToPixelsVec(6.452, 95.351), module, Oraculus::INPUT_RESET));
 
 		addOutput(createOutputCentered<BananutRed>(millimetersToPixelsVec(17.78, 113.488), module, Oraculus::OUTPUT_MONOPHONIC));
+		addOutput(createOutputCentered<BananutRedPoly>(millimetersToPixelsVec(6.452, 113.488), module, Oraculus::OUTPUT_FAN_OUT_1));
+		addOutput(createOutputCentered<BananutRedPoly>(millimetersToPixelsVec(29.108, 113.488), module, Oraculus::OUTPUT_FAN_OUT_2));
 
 #ifndef METAMODULE
 		addParam(createParamCentered<SeqButtonUp>(millimetersToPixelsVec(25.451, 55.801), module, Oraculus::PARAM_INCREASE));
@@ -327,6 +402,35 @@ struct OraculusWidget : SanguineModuleWidget {
 
 		addChild(createLightCentered<SmallLight<RedGreenBlueLight>>(millimetersToPixelsVec(20.537, 15.746), module, Oraculus::LIGHT_CHANNEL + 15 * 3));
 	}
+
+	void appendContextMenu(Menu* menu) override {
+		SanguineModuleWidget::appendContextMenu(menu);
+
+		Oraculus* module = dynamic_cast<Oraculus*>(this->module);
+
+		std::vector<std::string> offsetLabels;
+		for (int offset = 1; offset < PORT_MAX_CHANNELS; ++offset) {
+			offsetLabels.push_back(string::f("+%d", offset));
+		}
+
+		std::vector<std::string> channelLabels;
+		for (int channels = 1; channels <= PORT_MAX_CHANNELS; ++channels) {
+			channelLabels.push_back(string::f("%d", channels));
+		}
+
+		menu->addChild(new MenuSeparator);
+
+		for (int fanOutput = 0; fanOutput < Oraculus::kFanOutputs; ++fanOutput) {
+			menu->addChild(createIndexSubmenuItem(string::f("Fan-out %d channel offset", fanOutput + 1), offsetLabels,
+				[=]() {return module->fanOutOffsets[fanOutput] - 1; },
+				[=](int i) {module->fanOutOffsets[fanOutput] = i + 1; }
+			));
+			menu->addChild(createIndexSubmenuItem(string::f("Fan-out %d channels", fanOutput + 1), channelLabels,
+				[=]() {return module->fanOutChannels[fanOutput] - 1; },
+				[=](int i) {module->fanOutChannels[fanOutput] = i + 1; }
+			));
+		}
+	}
 };
 
 Model* modelOraculus = createModel<Oraculus, OraculusWidget>("Sanguine-Monsters-Oraculus");
\ No newline at end of file
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <rack.hpp>
+
+namespace phaseSines {
+    /* Sine of a phase in cycles, sin(2 pi phase), for float or float_4: no multiply by 2 pi is needed.
+       The phase is reduced to half a cycle either side of 0 and folded into the quarter cycle around it, where an odd
+       degree 7 polynomial fitted for least maximum error takes over.
+       Max absolute error is 7.4e-7 against double precision sin() for phases in [-2, 2]; beyond that, the error
+       grows only as far as the float phase itself loses bits. Peaks never exceed 1. */
+    template <typename T>
+    inline T sin2Pi(T phase) {
+        phase -= rack::simd::round(phase);
+        phase = rack::simd::ifelse(phase > 0.25f, 0.5f - phase, phase);
+        phase = rack::simd::ifelse(phase < -0.25f, -0.5f - phase, phase);
+
+        const T phaseSquared = phase * phase;
+        return phase * (6.28316404f + phaseSquared * (-41.3371424f + phaseSquared * (81.340769f +
+            phaseSquared * -70.9934346f)));
+    }
+}
@@ -8,6 +8,8 @@
 
 #include <iomanip>
 
+#include "displaysnapshot.hpp"
+
 #include "raiju.hpp"
 
 struct Raiju : SanguineModule {
@@ -56,7 +58,12 @@ struct Raiju : SanguineModule {
 
 	float voltages[kVoltagesCount];
 
-	std::string strVoltages[kVoltagesCount] = { "0.000" ,"0.000" ,"0.000" ,"0.000" ,"0.000" ,"0.000" ,"0.000" ,"0.000" };
+	struct DisplaySnapshot {
+		float voltages[kVoltagesCount];
+		int channelCount;
+	};
+
+	displaySnapshots::TripleBuffer<DisplaySnapshot> displayBuffer;
 
 	dsp::BooleanTrigger btButtons[kVoltagesCount];
 
@@ -82,6 +89,8 @@ struct Raiju : SanguineModule {
 		memset(voltages, 0, sizeof(float) * kVoltagesCount);
 
 		clockDivider.setDivision(kClockDivision);
+
+		publishDisplaySnapshot();
 	}
 
 	void process(const ProcessArgs& args) override {
@@ -104,17 +113,8 @@ struct Raiju : SanguineModule {
 			for (uint8_t voltage = 0; voltage < kVoltagesCount; ++voltage) {
 				params[PARAM_VOLTAGE_SELECTOR + voltage].setValue(voltage == selectedVoltage);
 
-				// Get channel voltages and update strings for displays
+				// Get channel voltages
 				voltages[voltage] = params[PARAM_VOLTAGE + voltage].getValue();
-				std::stringstream stringStream;
-				stringStream << std::fixed << std::setprecision(3) << std::setfill('0') << std::setw(6) << voltages[voltage];
-				if (voltages[voltage] < 0 && voltages[voltage] > -10) {
-					std::string tmpStr = stringStream.str();
-					tmpStr.replace(0, 1, "0");
-					tmpStr.insert(0, "-");
-					strVoltages[voltage] = tmpStr;
-				} else
-					strVoltages[voltage] = stringStream.str();
 
 				if (outputsConnected[voltage]) {
 					float_4 outputVoltages = voltages[voltage];
@@ -137,7 +137,21 @@ struct Raiju : SanguineModule {
 				outputs[OUTPUT_EIGHT_CHANNELS].writeVoltages(voltages);
 				outputs[OUTPUT_EIGHT_CHANNELS].setChannels(kVoltagesCount);
 			}
+
+			publishDisplaySnapshot();
+		}
+	}
+
+	// Display strings are formatted by the widget, keeping string allocations off the audio thread.
+	void publishDisplaySnapshot() {
+		DisplaySnapshot& snapshot = displayBuffer.getWriteBuffer();
+
+		for (int voltage = 0; voltage < kVoltagesCount; ++voltage) {
+			snapshot.voltages[voltage] = voltages[voltage];
 		}
+		snapshot.channelCount = currentChannelCount;
+
+		displayBuffer.publish();
 	}
 
 	void pollSwitches() {
@@ -182,6 +196,9 @@ struct Raiju : SanguineModule {
 };
 
 struct RaijuWidget : SanguineModuleWidget {
+	int channelCount = 1;
+	std::string strVoltages[Raiju::kVoltagesCount] = { "0.000" ,"0.000" ,"0.000" ,"0.000" ,"0.000" ,"0.000" ,"0.000" ,"0.000" };
+
 	explicit RaijuWidget(Raiju* module) {
 		setModule(module);
 
@@ -353,17 +370,42 @@ struct RaijuWidget : SanguineModuleWidget {
 #endif
 
 		if (module) {
-			displayChannelCount->values.numberValue = (&module->currentChannelCount);
-
-			displayVoltage1->values.displayText = &module->strVoltages[0];
-			displayVoltage2->values.displayText = &module->strVoltages[1];
-			displayVoltage3->values.displayText = &module->strVoltages[2];
-			displayVoltage4->values.displayText = &module->strVoltages[3];
-			displayVoltage5->values.displayText = &module->strVoltages[4];
-			displayVoltage6->values.displayText = &module->strVoltages[5];
-			displayVoltage7->values.displayText = &module->strVoltages[6];
-			displayVoltage8->values.displayText = &module->strVoltages[7];
+			displayChannelCount->values.numberValue = &channelCount;
+
+			displayVoltage1->values.displayText = &strVoltages[0];
+			displayVoltage2->values.displayText = &strVoltages[1];
+			displayVoltage3->values.displayText = &strVoltages[2];
+			displayVoltage4->values.displayText = &strVoltages[3];
+			displayVoltage5->values.displayText = &strVoltages[4];
+			displayVoltage6->values.displayText = &strVoltages[5];
+			displayVoltage7->values.displayText = &strVoltages[6];
+			displayVoltage8->values.displayText = &strVoltages[7];
+		}
+	}
+
+	void step() override {
+		Raiju* raijuModule = dynamic_cast<Raiju*>(this->module);
+
+		if (raijuModule && raijuModule->displayBuffer.consume()) {
+			const Raiju::DisplaySnapshot& snapshot = raijuModule->displayBuffer.getReadBuffer();
+
+			channelCount = snapshot.channelCount;
+
+			// Update strings for displays
+			for (int voltage = 0; voltage < Raiju::kVoltagesCount; ++voltage) {
+				std::stringstream stringStream;
+				stringStream << std::fixed << std::setprecision(3) << std::setfill('0') << std::setw(6) << snapshot.voltages[voltage];
+				if (snapshot.voltages[voltage] < 0 && snapshot.voltages[voltage] > -10) {
+					std::string tmpStr = stringStream.str();
+					tmpStr.replace(0, 1, "0");
+					tmpStr.insert(0, "-");
+					strVoltages[voltage] = tmpStr;
+				} else
+					strVoltages[voltage] = stringStream.str();
+			}
 		}
+
+		SanguineModuleWidget::step();
 	}
 };
 
@@ -8,6 +8,8 @@
 #pragma GCC diagnostic pop
 
 #include "bjorklund.hpp"
+#include "displaysnapshot.hpp"
+#include "triggerbank.hpp"
 #include <array>
 
 #include "sphinx.hpp"
@@ -42,6 +44,8 @@ struct Sphinx : SanguineModule {
 		OUTPUT_GATE,
 		OUTPUT_ACCENT,
 		OUTPUT_EOC,
+		OUTPUT_FUTURE_STEPS,
+		OUTPUT_NEXT_HIT,
 		OUTPUTS_COUNT
 	};
 
@@ -80,6 +84,8 @@ struct Sphinx : SanguineModule {
 	int patternAccents = 0;
 
 	int patternChecksum = 0;
+	// Increases every time the pattern is recalculated; the display rebuilds its geometry when it changes.
+	int patternRevision = 0;
 
 	int lastPatternFill = 0;
 	int lastPatternLength = 0;
@@ -88,13 +94,25 @@ struct Sphinx : SanguineModule {
 	int currentStep = 0;
 	int turing = 0;
 
+	/* The pattern repeated to fill 64 bits, forwards and backwards, so the steps after any step are a single
+	   shift away. */
+	uint64_t tiledSequence = 0;
+	uint64_t tiledAccents = 0;
+	uint64_t tiledReverseSequence = 0;
+	uint64_t tiledReverseAccents = 0;
+
 	sphinx::PatternStyle lastPatternStyle = sphinx::RANDOM_PATTERN;
 	sphinx::PatternStyle patternStyle = sphinx::EUCLIDEAN_PATTERN;
 
 	static const int kClockDivider = 16;
 
-	dsp::SchmittTrigger stClockInput;
-	dsp::SchmittTrigger stResetInput;
+	enum TriggerLanes {
+		LANE_RESET,
+		LANE_CLOCK,
+		LANES_COUNT
+	};
+
+	triggerBanks::SchmittTriggerBank<LANES_COUNT> stInputs;
 
 	dsp::PulseGenerator pgGate;
 	dsp::PulseGenerator pgAccent;
@@ -106,6 +124,8 @@ struct Sphinx : SanguineModule {
 
 	sphinx::GateMode gateMode = sphinx::GM_TRIGGER;
 
+	displaySnapshots::TripleBuffer<sphinx::DisplaySnapshot> displayBuffer;
+
 	Sphinx() {
 		config(PARAMS_COUNT, INPUTS_COUNT, OUTPUTS_COUNT, LIGHTS_COUNT);
 
@@ -133,6 +153,9 @@ struct Sphinx : SanguineModule {
 		configOutput(OUTPUT_GATE, "Gate");
 		configOutput(OUTPUT_ACCENT, "Accent");
 		configOutput(OUTPUT_EOC, "End of cycle");
+		configOutput(OUTPUT_FUTURE_STEPS, string::f("Next %d steps: gates on channels 1-%d, accents on channels %d-%d",
+			sphinx::kLookaheadSteps, sphinx::kLookaheadSteps, sphinx::kLookaheadSteps + 1, sphinx::kLookaheadSteps * 2));
+		configOutput(OUTPUT_NEXT_HIT, string::f("Steps until next hit (%.1f V per step)", sphinx::kNextHitVoltsPerStep));
 
 		finalSequence.fill(0);
 		finalAccents.fill(0);
@@ -155,21 +178,26 @@ struct Sphinx : SanguineModule {
 		}
 
 		bool bNextStep = false;
+		bool bStepReset = false;
+
+		float_4 triggerVoltages = { inputs[INPUT_RESET].getVoltage(), inputs[INPUT_CLOCK].getVoltage(), 0.f, 0.f };
+		int triggeredInputs = stInputs.processBits(0, triggerVoltages);
 
 		// Reset sequence.
 		if (bHaveReset) {
-			if (stResetInput.process(inputs[INPUT_RESET].getVoltage())) {
+			if (triggeredInputs & (1 << LANE_RESET)) {
 				if (!params[PARAM_REVERSE].getValue()) {
 					currentStep = patternLength + patternPadding;
 				} else {
 					currentStep = 0;
 				}
 				bCycleReset = true;
+				bStepReset = true;
 			}
 		}
 
 		if (bHaveClock) {
-			if (stClockInput.process(inputs[INPUT_CLOCK].getVoltage())) {
+			if (triggeredInputs & (1 << LANE_CLOCK)) {
 				bNextStep = true;
 			}
 		}
@@ -222,6 +250,11 @@ struct Sphinx : SanguineModule {
 			}
 		}
 
+		if (bNextStep || bStepReset) {
+			publishDisplaySnapshot();
+			setLookaheadOutputs();
+		}
+
 		bool bGatePulse = pgGate.process(args.sampleTime);
 		bool bAccentPulse = pgAccent.process(args.sampleTime);
 
@@ -293,6 +326,9 @@ struct Sphinx : SanguineModule {
 
 			gateMode = static_cast<sphinx::GateMode>(params[PARAM_GATE_MODE].getValue());
 
+			// Direction may have changed.
+			setLookaheadOutputs();
+
 			const float sampleTime = args.sampleTime * kClockDivider;
 
 			// Update lights.
@@ -324,6 +360,25 @@ struct Sphinx : SanguineModule {
 		}
 	}
 
+	/* Picks count different steps out of length with a partial Fisher-Yates shuffle: bit n is set when step n is
+	   picked. Takes exactly count draws, unlike rejection sampling which could loop for a long time. */
+	uint32_t getRandomSteps(const int length, int count) {
+		int steps[sphinx::kMaxLength];
+		for (int step = 0; step < length; ++step) {
+			steps[step] = step;
+		}
+
+		count = std::min(count, length);
+
+		uint32_t stepBits = 0;
+		for (int pick = 0; pick < count; ++pick) {
+			int swapIndex = pick + pcgRng(length - pick);
+			std::swap(steps[pick], steps[swapIndex]);
+			stepBits |= 1u << steps[pick];
+		}
+		return stepBits;
+	}
+
 	int getFibonacci(int n) {
 		return (n < 2) ? n : getFibonacci(n - 1) + getFibonacci(n - 2);
 	}
@@ -361,30 +416,18 @@ struct Sphinx : SanguineModule {
 			case sphinx::RANDOM_PATTERN: {
 				if (lastPatternLength != patternLength || lastPatternFill != patternFill ||
 					lastPatternStyle != patternStyle) {
-					int num = 0;
+					uint32_t stepBits = getRandomSteps(patternLength, patternFill);
 					calculatedSequence.resize(patternLength);
-					std::fill(calculatedSequence.begin(), calculatedSequence.end(), 0);
-					int fill = 0;
-					while (fill < patternFill) {
-						if (ldexpf(pcgRng(), -32) < static_cast<float>(patternFill) / static_cast<float>(patternLength)) {
-							calculatedSequence[num % patternLength] = 1;
-							++fill;
-						}
-						++num;
+					for (int step = 0; step < patternLength; ++step) {
+						calculatedSequence[step] = (stepBits >> step) & 1;
 					}
 				}
 				if (patternAccents && (lastPatternAccents != patternAccents || lastPatternFill != patternFill ||
 					patternStyle != lastPatternStyle)) {
-					int num = 0;
+					uint32_t accentBits = getRandomSteps(patternFill, patternAccents);
 					calculatedAccents.resize(patternFill);
-					std::fill(calculatedAccents.begin(), calculatedAccents.end(), 0);
-					int accentNum = 0;
-					while (accentNum < patternAccents) {
-						if (ldexpf(pcgRng(), -32) < static_cast<float>(patternAccents) / static_cast<float>(patternFill)) {
-							calculatedAccents[num % patternFill] = 1;
-							++accentNum;
-						}
-						++num;
+					for (int accent = 0; accent < patternFill; ++accent) {
+						calculatedAccents[accent] = (accentBits >> accent) & 1;
 					}
 				}
 				break;
@@ -436,7 +479,81 @@ struct Sphinx : SanguineModule {
 			}
 		}
 
+		tilePattern(patternSize);
+
+		++patternRevision;
+
 		bCalculate = false;
+
+		publishDisplaySnapshot();
+		setLookaheadOutputs();
+	}
+
+	void tilePattern(const int patternSize) {
+		tiledSequence = 0;
+		tiledAccents = 0;
+		tiledReverseSequence = 0;
+		tiledReverseAccents = 0;
+
+		for (int bit = 0; bit < 64; ++bit) {
+			int step = bit % patternSize;
+			int reverseStep = patternSize - 1 - step;
+			tiledSequence |= static_cast<uint64_t>(finalSequence[step]) << bit;
+			tiledAccents |= static_cast<uint64_t>(finalAccents[step]) << bit;
+			tiledReverseSequence |= static_cast<uint64_t>(finalSequence[reverseStep]) << bit;
+			tiledReverseAccents |= static_cast<uint64_t>(finalAccents[reverseStep]) << bit;
+		}
+	}
+
+	// Sets the future steps and next hit outputs from the tiled pattern: a shift and a bit scan per update.
+	void setLookaheadOutputs() {
+		const int patternSize = patternLength + patternPadding;
+		const bool bReverse = params[PARAM_REVERSE].getValue();
+
+		uint64_t futureSequence;
+		uint64_t futureAccents;
+
+		if (!bReverse) {
+			// After a reset the step sits one past the end; the next one is the first.
+			int nextStep = currentStep + 1 >= patternSize ? 0 : currentStep + 1;
+			futureSequence = tiledSequence >> nextStep;
+			futureAccents = tiledAccents >> nextStep;
+		} else {
+			// Steps left past the end by a shorter pattern count down like the sequencer does.
+			int nextStep = currentStep - 1 < 0 ? patternSize - 1 : std::min(currentStep - 1, patternSize - 1);
+			int offset = patternSize - 1 - nextStep;
+			futureSequence = tiledReverseSequence >> offset;
+			futureAccents = tiledReverseAccents >> offset;
+		}
+
+		for (int step = 0; step < sphinx::kLookaheadSteps; ++step) {
+			outputs[OUTPUT_FUTURE_STEPS].setVoltage(((futureSequence >> step) & 1) * 10.f, step);
+			outputs[OUTPUT_FUTURE_STEPS].setVoltage(((futureAccents >> step) & 1) * 10.f,
+				step + sphinx::kLookaheadSteps);
+		}
+		outputs[OUTPUT_FUTURE_STEPS].setChannels(sphinx::kLookaheadSteps * 2);
+
+		// The shifted pattern still holds more than a full cycle, so a hit is found if there is one.
+		int stepsToHit = futureSequence ? __builtin_ctzll(futureSequence) + 1 : 0;
+		outputs[OUTPUT_NEXT_HIT].setVoltage(stepsToHit * sphinx::kNextHitVoltsPerStep);
+	}
+
+	void publishDisplaySnapshot() {
+		sphinx::DisplaySnapshot& snapshot = displayBuffer.getWriteBuffer();
+
+		snapshot.sequence = finalSequence;
+		snapshot.accents = finalAccents;
+		snapshot.currentStep = currentStep;
+		snapshot.patternFill = patternFill;
+		snapshot.patternLength = patternLength;
+		snapshot.patternPadding = patternPadding;
+		snapshot.patternRotation = patternRotation;
+		snapshot.patternAccents = patternAccents;
+		snapshot.patternAccentRotation = patternAccentRotation;
+		snapshot.patternRevision = patternRevision;
+		snapshot.patternStyle = patternStyle;
+
+		displayBuffer.publish();
 	}
 
 	void onPortChange(const PortChangeEvent& e) override {
@@ -463,13 +580,19 @@ struct Sphinx : SanguineModule {
 
 struct SphinxDisplay : TransparentWidget {
 	Sphinx* module = nullptr;
-	std::array<bool, sphinx::kMaxLength * 2>* sequence = nullptr;
-	std::array<bool, sphinx::kMaxLength * 2>* accents = nullptr;
-	int* currentStep = nullptr;
-	int* patternFill = nullptr;
-	int* patternLength = nullptr;
-	int* patternPadding = nullptr;
-	sphinx::PatternStyle* patternStyle = nullptr;
+	const sphinx::DisplaySnapshot* snapshot = nullptr;
+
+	// Geometry of the last drawn pattern: rebuilt only when the pattern revision changes.
+	int cachedRevision = -1;
+	unsigned cachedLength = 0;
+	bool bCachedFillDots = false;
+	std::array<bool, sphinx::kMaxLength> cachedSequence = {};
+	Vec stepPositions[sphinx::kMaxLength];
+
+	float circleX = 0.f;
+	float circleY = 0.f;
+	float radius1 = 0.f;
+	float radius2 = 0.f;
 
 	void draw(const DrawArgs& args) override {
 		// Display border.
@@ -487,61 +610,61 @@ struct SphinxDisplay : TransparentWidget {
 	void drawLayer(const DrawArgs& args, int layer) override {
 		if (layer == 1) {
 			if (module && !module->isBypassed()) {
-				drawDisplayBackground(args.vg, *patternStyle);
+				drawDisplayBackground(args.vg, snapshot->patternStyle);
 
 				// Shape.
-				if (accents && currentStep && patternFill && patternLength && patternPadding && patternStyle) {
-					Rect polyBoxSize = Rect(Vec(2, 2), box.size.minus(Vec(2, 2)));
-
-					float circleX = 0.5f * polyBoxSize.size.x + 1;
-					float circleY = 0.5f * polyBoxSize.size.y + 1;
-					const float radius1 = 0.45f * polyBoxSize.size.x;
-					const float radius2 = 0.35f * polyBoxSize.size.x;
-
-					unsigned length = *patternLength + *patternPadding;
-
-					drawCircles(args.vg, *patternStyle, circleX, circleY, radius1, radius2);
-					drawInactiveSteps(args.vg, *patternStyle, circleX, circleY, radius1, radius2, length,
-						sequence->data(), accents->data());
-					drawPath(args.vg, *patternStyle, circleX, circleY, radius1, radius2, length, sequence->data(),
-						accents->data(), patternFill);
-					drawActiveSteps(args.vg, *patternStyle, circleX, circleY, radius1, radius2, length, sequence->data(),
-						accents->data());
-					drawCurrentStep(args.vg, *patternStyle, circleX, circleY, radius1, radius2, length, sequence->data(),
-						accents->data(), *currentStep);
-					drawRectHalo(args, box.size, sphinx::displayColors[*patternStyle].activeColor, 55, 0.f);
+				if (snapshot->patternRevision != cachedRevision) {
+					updateGeometry(snapshot->patternRevision, snapshot->patternLength + snapshot->patternPadding,
+						snapshot->sequence.data(), snapshot->accents.data(), snapshot->patternFill == 1);
 				}
+
+				drawPattern(args.vg, snapshot->patternStyle, snapshot->currentStep);
+				drawRectHalo(args, box.size, sphinx::displayColors[snapshot->patternStyle].activeColor, 55, 0.f);
 			} else if (!module) {
 				drawDisplayBackground(args.vg, 0);
 
 				// Shape.
-				Rect polyBoxSize = Rect(Vec(2, 2), box.size.minus(Vec(2, 2)));
-
-				float circleX = 0.5f * polyBoxSize.size.x + 1;
-				float circleY = 0.5f * polyBoxSize.size.y + 1;
-				const float radius1 = 0.45f * polyBoxSize.size.x;
-				const float radius2 = 0.35f * polyBoxSize.size.x;
-
-				unsigned length = 0;
-
-				length = 16;
-
-				drawCircles(args.vg, 0, circleX, circleY, radius1, radius2);
-				drawInactiveSteps(args.vg, 0, circleX, circleY, radius1, radius2, length,
-					sphinx::browserSequence.data(), nullptr);
-				drawPath(args.vg, 0, circleX, circleY, radius1, radius2, length, sphinx::browserSequence.data(),
-					nullptr, nullptr);
-				drawActiveSteps(args.vg, 0, circleX, circleY, radius1, radius2, length, sphinx::browserSequence.data(),
-					nullptr);
-				drawCurrentStep(args.vg, 0, circleX, circleY, radius1, radius2, length, sphinx::browserSequence.data(),
-					nullptr, 0);
+				if (cachedRevision != 0) {
+					updateGeometry(0, 16, sphinx::browserSequence.data(), nullptr, false);
+				}
+
+				drawPattern(args.vg, 0, 0);
 			}
 		}
 		Widget::drawLayer(args, layer);
 	}
 
-	void drawCircles(NVGcontext* vg, const int patternStyle, const float& circleX,
-		const float& circleY, const float& radius1, const float& radius2) {
+	void updateGeometry(const int revision, const unsigned length, const bool* sequence, const bool* accents,
+		const bool bFillDots) {
+		static const sphinx::UnitCircleTable unitCircles;
+
+		Rect polyBoxSize = Rect(Vec(2, 2), box.size.minus(Vec(2, 2)));
+
+		circleX = 0.5f * polyBoxSize.size.x + 1;
+		circleY = 0.5f * polyBoxSize.size.y + 1;
+		radius1 = 0.45f * polyBoxSize.size.x;
+		radius2 = 0.35f * polyBoxSize.size.x;
+
+		cachedRevision = revision;
+		cachedLength = std::min(length, static_cast<unsigned>(sphinx::kMaxLength));
+		bCachedFillDots = bFillDots;
+
+		for (unsigned step = 0; step < cachedLength; ++step) {
+			float r = (accents && accents[step]) ? radius1 : radius2;
+			stepPositions[step] = Vec(circleX, circleY).plus(unitCircles.points[cachedLength][step].mult(r));
+			cachedSequence[step] = sequence[step];
+		}
+	}
+
+	void drawPattern(NVGcontext* vg, const int patternStyle, const int currentStep) {
+		drawCircles(vg, patternStyle);
+		drawInactiveSteps(vg, patternStyle);
+		drawPath(vg, patternStyle);
+		drawActiveSteps(vg, patternStyle);
+		drawCurrentStep(vg, patternStyle, currentStep);
+	}
+
+	void drawCircles(NVGcontext* vg, const int patternStyle) {
 		// Circles.
 		nvgBeginPath(vg);
 
@@ -556,46 +679,34 @@ struct SphinxDisplay : TransparentWidget {
 		nvgStrokeColor(vg, sphinx::displayColors[patternStyle].activeColor);
 	}
 
-	void drawInactiveSteps(NVGcontext* vg, const int patternStyle, const float& circleX,
-		const float& circleY, const float& radius1, const float& radius2, const unsigned length,
-		const bool* sequence, const bool* accents) {
+	void drawInactiveSteps(NVGcontext* vg, const int patternStyle) {
 		nvgBeginPath(vg);
 
-		for (unsigned step = 0; step < length; ++step) {
-			if (!sequence[step]) {
-				float r = (accents && accents[step]) ? radius1 : radius2;
-				float x = circleX + r * cosf(sphinx::kDoublePi * step / length - sphinx::kHalfPi);
-				float y = circleY + r * sinf(sphinx::kDoublePi * step / length - sphinx::kHalfPi);
-
-				nvgBeginPath(vg);
-				nvgFillColor(vg, sphinx::displayColors[patternStyle].backgroundColor);
-				nvgStrokeColor(vg, sphinx::displayColors[patternStyle].inactiveColor);
-				nvgStrokeWidth(vg, 1.f);
-				nvgCircle(vg, x, y, 2.f);
-				nvgFill(vg);
-				nvgStroke(vg);
+		for (unsigned step = 0; step < cachedLength; ++step) {
+			if (!cachedSequence[step]) {
+				nvgCircle(vg, stepPositions[step].x, stepPositions[step].y, 2.f);
 			}
 		}
+
+		nvgFillColor(vg, sphinx::displayColors[patternStyle].backgroundColor);
+		nvgStrokeColor(vg, sphinx::displayColors[patternStyle].inactiveColor);
+		nvgStrokeWidth(vg, 1.f);
+		nvgFill(vg);
+		nvgStroke(vg);
 	}
 
-	void drawPath(NVGcontext* vg, const int patternStyle, const float& circleX,
-		const float& circleY, const float& radius1, const float& radius2, const unsigned length,
-		const bool* sequence, const bool* accents, const int* patternFill) {
+	void drawPath(NVGcontext* vg, const int patternStyle) {
 		bool bFirst = true;
 		nvgBeginPath(vg);
 		nvgStrokeColor(vg, sphinx::displayColors[patternStyle].activeColor);
 		nvgStrokeWidth(vg, 1.f);
 
-		for (unsigned int step = 0; step < length; ++step) {
-			if (sequence[step]) {
-				float a = step / static_cast<float>(length);
-				float r = (accents && accents[step]) ? radius1 : radius2;
-				float x = circleX + r * cosf(sphinx::kDoublePi * a - sphinx::kHalfPi);
-				float y = circleY + r * sinf(sphinx::kDoublePi * a - sphinx::kHalfPi);
+		for (unsigned int step = 0; step < cachedLength; ++step) {
+			if (cachedSequence[step]) {
+				const Vec& p = stepPositions[step];
 
-				Vec p(x, y);
-				if (patternFill && *patternFill == 1) {
-					nvgCircle(vg, x, y, 2.f);
+				if (bCachedFillDots) {
+					nvgCircle(vg, p.x, p.y, 2.f);
 				}
 				if (bFirst) {
 					nvgMoveTo(vg, p.x, p.y);
@@ -609,36 +720,34 @@ struct SphinxDisplay : TransparentWidget {
 		nvgStroke(vg);
 	}
 
-	void drawActiveSteps(NVGcontext* vg, const int patternStyle, const float& circleX,
-		const float& circleY, const float& radius1, const float& radius2, const unsigned length,
-		const bool* sequence, const bool* accents) {
-		for (unsigned step = 0; step < length; ++step) {
-			if (sequence[step]) {
-				float r = (accents && accents[step]) ? radius1 : radius2;
-				float x = circleX + r * cosf(sphinx::kDoublePi * step / length - sphinx::kHalfPi);
-				float y = circleY + r * sinf(sphinx::kDoublePi * step / length - sphinx::kHalfPi);
-
-				nvgBeginPath(vg);
-				nvgFillColor(vg, sphinx::displayColors[patternStyle].backgroundColor);
-				nvgStrokeWidth(vg, 1.f);
-				nvgStrokeColor(vg, sphinx::displayColors[patternStyle].activeColor);
-				nvgCircle(vg, x, y, 2.f);
-				nvgFill(vg);
-				nvgStroke(vg);
+	void drawActiveSteps(NVGcontext* vg, const int patternStyle) {
+		nvgBeginPath(vg);
+
+		for (unsigned step = 0; step < cachedLength; ++step) {
+			if (cachedSequence[step]) {
+				nvgCircle(vg, stepPositions[step].x, stepPositions[step].y, 2.f);
 			}
 		}
+
+		nvgFillColor(vg, sphinx::displayColors[patternStyle].backgroundColor);
+		nvgStrokeWidth(vg, 1.f);
+		nvgStrokeColor(vg, sphinx::displayColors[patternStyle].activeColor);
+		nvgFill(vg);
+		nvgStroke(vg);
 	}
 
-	void drawCurrentStep(NVGcontext* vg, const int patternStyle, const float& circleX,
-		const float& circleY, const float& radius1, const float& radius2, const unsigned length,
-		const bool* sequence, const bool* accents, const int currentStep) {
-		float r = (accents && accents[currentStep]) ? radius1 : radius2;
-		float x = circleX + r * cosf(sphinx::kDoublePi * currentStep / length - sphinx::kHalfPi);
-		float y = circleY + r * sinf(sphinx::kDoublePi * currentStep / length - sphinx::kHalfPi);
+	void drawCurrentStep(NVGcontext* vg, const int patternStyle, const int currentStep) {
+		if (cachedLength == 0) {
+			return;
+		}
+
+		// After a reset the step sits one past the end, which is drawn at the first step.
+		const Vec& p = stepPositions[currentStep % cachedLength];
+
 		nvgBeginPath(vg);
 		nvgStrokeColor(vg, sphinx::displayColors[patternStyle].activeColor);
 		nvgFillColor(vg, sphinx::displayColors[patternStyle].activeColor);
-		nvgCircle(vg, x, y, 2.);
+		nvgCircle(vg, p.x, p.y, 2.);
 		nvgStrokeWidth(vg, 1.5f);
 		nvgFill(vg);
 		nvgStroke(vg);
@@ -660,6 +769,9 @@ struct TL1105Latch : TL1105 {
 };
 
 struct SphinxWidget : SanguineModuleWidget {
+	// Copy of the module's latest display snapshot; the displays point here instead of into the module.
+	sphinx::DisplaySnapshot displaySnapshot = {};
+
 	explicit SphinxWidget(Sphinx* module) {
 		setModule(module);
 
@@ -687,6 +799,10 @@ struct SphinxWidget : SanguineModuleWidget {
 		addChild(createLightCentered<SmallLight<RedLight>>(millimetersToPixelsVec(41.862, 26.411), module, Sphinx::LIGHT_EOC));
 		addChild(createOutputCentered<BananutBlack>(millimetersToPixelsVec(48.472, 26.411), module, Sphinx::OUTPUT_EOC));
 
+		addChild(createOutputCentered<BananutRedPoly>(millimetersToPixelsVec(7.326, 13.947), module,
+			Sphinx::OUTPUT_FUTURE_STEPS));
+		addChild(createOutputCentered<BananutRed>(millimetersToPixelsVec(7.326, 26.411), module, Sphinx::OUTPUT_NEXT_HIT));
+
 		addChild(createParamCentered<BefacoTinyKnobRed>(millimetersToPixelsVec(10.386, 40.197), module, Sphinx::PARAM_LENGTH));
 		addChild(createParamCentered<BefacoTinyKnobBlack>(millimetersToPixelsVec(27.82, 40.197), module, Sphinx::PARAM_STEPS));
 		addChild(createParamCentered<BefacoTinyKnobRed>(millimetersToPixelsVec(45.414, 40.197), module, Sphinx::PARAM_ROTATION));
@@ -749,21 +865,25 @@ struct SphinxWidget : SanguineModuleWidget {
 		addChild(bloodLight);
 
 		if (module) {
-			sphinxDisplay->sequence = &module->finalSequence;
-			sphinxDisplay->accents = &module->finalAccents;
-			sphinxDisplay->patternLength = &module->patternLength;
-			sphinxDisplay->patternPadding = &module->patternPadding;
-			sphinxDisplay->patternFill = &module->patternFill;
-			sphinxDisplay->currentStep = &module->currentStep;
-			sphinxDisplay->patternStyle = &module->patternStyle;
-
-			displayAccentRotation->values.numberValue = &module->patternAccentRotation;
-			displayLength->values.numberValue = &module->patternLength;
-			displayFill->values.numberValue = &module->patternFill;
-			displayRotation->values.numberValue = &module->patternRotation;
-			displayPadding->values.numberValue = &module->patternPadding;
-			displayAccent->values.numberValue = &module->patternAccents;
+			sphinxDisplay->snapshot = &displaySnapshot;
+
+			displayAccentRotation->values.numberValue = &displaySnapshot.patternAccentRotation;
+			displayLength->values.numberValue = &displaySnapshot.patternLength;
+			displayFill->values.numberValue = &displaySnapshot.patternFill;
+			displayRotation->values.numberValue = &displaySnapshot.patternRotation;
+			displayPadding->values.numberValue = &displaySnapshot.patternPadding;
+			displayAccent->values.numberValue = &displaySnapshot.patternAccents;
+		}
+	}
+
+	void step() override {
+		Sphinx* sphinxModule = dynamic_cast<Sphinx*>(this->module);
+
+		if (sphinxModule && sphinxModule->displayBuffer.consume()) {
+			displaySnapshot = sphinxModule->displayBuffer.getReadBuffer();
 		}
+
+		SanguineModuleWidget::step();
 	}
 };
 
@@ -5,6 +5,10 @@
 namespace sphinx {
     static const int kMaxLength = 32;
 
+    // Steps shown by the future steps output: gates on the first channels, accents on the rest.
+    static const int kLookaheadSteps = 8;
+    static const float kNextHitVoltsPerStep = 0.1f;
+
     enum PatternStyle {
         EUCLIDEAN_PATTERN,
         RANDOM_PATTERN,
@@ -56,6 +60,21 @@ namespace sphinx {
         {true, false, false}
     };
 
+    // Everything SphinxDisplay and the numeric displays show, published by the engine.
+    struct DisplaySnapshot {
+        std::array<bool, kMaxLength * 2> sequence;
+        std::array<bool, kMaxLength * 2> accents;
+        int currentStep;
+        int patternFill;
+        int patternLength;
+        int patternPadding;
+        int patternRotation;
+        int patternAccents;
+        int patternAccentRotation;
+        int patternRevision;
+        PatternStyle patternStyle;
+    };
+
     struct DisplayColors {
         NVGcolor backgroundColor;
         NVGcolor inactiveColor;
@@ -72,6 +91,21 @@ namespace sphinx {
     static constexpr float kDoublePi = 2.f * M_PI;
     static constexpr float kHalfPi = 0.5f * M_PI;
 
+    /* Unit circle positions of every step for every pattern length, starting at twelve o'clock.
+       The display scales these instead of calling cosf/sinf for every step on every frame. */
+    struct UnitCircleTable {
+        math::Vec points[kMaxLength + 1][kMaxLength];
+
+        UnitCircleTable() {
+            for (int length = 1; length <= kMaxLength; ++length) {
+                for (int step = 0; step < length; ++step) {
+                    float angle = kDoublePi * step / length - kHalfPi;
+                    points[length][step] = math::Vec(cosf(angle), sinf(angle));
+                }
+            }
+        }
+    };
+
     static const std::vector<std::string> patternStyleLabels = {
         "Euclidean",
         "Random",
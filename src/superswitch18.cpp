@@ -11,6 +11,7 @@
 #include "pcg_random.hpp"
 #pragma GCC diagnostic pop
 
+#include "controlscanner.hpp"
 #include "switches.hpp"
 #ifndef METAMODULE
 #include "manus.hpp"
@@ -82,18 +83,16 @@ struct SuperSwitch18 : SanguineModule {
 		LIGHTS_COUNT
 	};
 
-	dsp::BooleanTrigger btDecrease;
-	dsp::BooleanTrigger btIncrease;
-	dsp::BooleanTrigger btRandom;
-	dsp::BooleanTrigger btReset;
-	dsp::BooleanTrigger btSteps[superSwitches::kMaxSteps];
+	// Buttons are scanned and step buttons written back on the lights turn.
+	controlScanners::ButtonScanner<superSwitches::TRANSPORT_BUTTONS_COUNT> transportButtons;
+	controlScanners::ButtonScanner<superSwitches::kMaxSteps> stepButtons;
 	dsp::SchmittTrigger stInputDecrease;
 	dsp::SchmittTrigger stInputIncrease;
 	dsp::SchmittTrigger stInputRandom;
 	dsp::SchmittTrigger stInputReset;
 #ifndef METAMODULE
 	dsp::SchmittTrigger stDirectSteps[superSwitches::kMaxSteps];
-	Manus* manusExpander = nullptr;
+	manus::ControlsMessage manusMessages[2];
 #endif
 
 	bool bLastOneShotValue = false;
@@ -105,6 +104,9 @@ struct SuperSwitch18 : SanguineModule {
 	bool bResetMutex = false;
 	bool bStepsMutex = false;
 
+	// The steps input selects the step every sample instead of setting the step count.
+	bool bAddressMode = false;
+
 	bool bHaveStepsCable = false;
 	bool bHaveResetCable = false;
 	bool bHaveDecreaseCable = false;
@@ -163,6 +165,12 @@ struct SuperSwitch18 : SanguineModule {
 		params[PARAM_STEP1].setValue(1);
 		params[PARAM_RESET_TO_FIRST_STEP].setValue(1);
 		pcgRng = pcg32(static_cast<int>(std::round(system::getUnixTime())));
+
+#ifndef METAMODULE
+		rightExpander.producerMessage = &manusMessages[0];
+		rightExpander.consumerMessage = &manusMessages[1];
+#endif
+
 		lightsDivider.setDivision(kLightsFrequency);
 	};
 
@@ -174,38 +182,43 @@ struct SuperSwitch18 : SanguineModule {
 
 		float sampleTime;
 
+		int pressedButtons = 0;
+
 		if (bIsLightsTurn) {
 			sampleTime = args.sampleTime * kLightsFrequency;
 
+			pressedButtons = transportButtons.scan(params, PARAM_DECREASE);
+
 			handleParameterControls();
 
 			lights[LIGHT_EXPANDER].setBrightnessSmooth(
 				bHasExpander * kSanguineButtonLightValue, sampleTime);
 		}
 
-		checkReset();
+		checkReset(pressedButtons);
 
-		handleClockControls();
+		handleClockControls(pressedButtons);
 
-		if (!bHasExpander) {
-			for (int stepNum = 0; stepNum < superSwitches::kMaxSteps; ++stepNum) {
-				handleStepButtons(stepNum);
+		if (bAddressMode && bHaveStepsCable) {
+			handleStepAddress();
+		}
 
-				params[stepNum].setValue(stepNum == selectedOut ? 1 : stepNum < stepCount ? 0 : 2);
-			}
+		if (bIsLightsTurn) {
+			handleStepButtons();
+		}
 
+		if (!bHasExpander) {
 			copyVoltages();
 
 			setUnselectedOutputs();
 
 			bResetMutex = false;
 		} else {
-			for (int stepNum = 0; stepNum < superSwitches::kMaxSteps; ++stepNum) {
-				handleStepButtons(stepNum);
+			const manus::ControlsMessage* controlsMessage =
+				static_cast<manus::ControlsMessage*>(rightExpander.consumerMessage);
 
-				handleExpanderInput(stepNum);
-
-				params[stepNum].setValue(stepNum == selectedOut ? 1 : stepNum < stepCount ? 0 : 2);
+			for (int stepNum = 0; stepNum < superSwitches::kMaxSteps; ++stepNum) {
+				handleExpanderInput(stepNum, controlsMessage);
 			}
 
 			copyVoltages();
@@ -213,10 +226,14 @@ struct SuperSwitch18 : SanguineModule {
 			setUnselectedOutputs();
 
 			if (bIsLightsTurn) {
-				setExpanderLights(sampleTime);
+				sendManusStatus();
 			}
 			bResetMutex = false;
 		}
+
+		if (bIsLightsTurn) {
+			updateStepButtons();
+		}
 	}
 #else
 	void process(const ProcessArgs& args) override {
@@ -226,20 +243,26 @@ struct SuperSwitch18 : SanguineModule {
 
 		float sampleTime;
 
+		int pressedButtons = 0;
+
 		if (bIsLightsTurn) {
 			sampleTime = args.sampleTime * kLightsFrequency;
 
+			pressedButtons = transportButtons.scan(params, PARAM_DECREASE);
+
 			handleParameterControls();
 		}
 
-		checkReset();
+		checkReset(pressedButtons);
 
-		handleClockControls();
+		handleClockControls(pressedButtons);
 
-		for (int stepNum = 0; stepNum < superSwitches::kMaxSteps; ++stepNum) {
-			handleStepButtons(stepNum);
+		if (bAddressMode && bHaveStepsCable) {
+			handleStepAddress();
+		}
 
-			params[stepNum].setValue(stepNum == selectedOut ? 1 : stepNum < stepCount ? 0 : 2);
+		if (bIsLightsTurn) {
+			handleStepButtons();
 		}
 
 		copyVoltages();
@@ -247,19 +270,21 @@ struct SuperSwitch18 : SanguineModule {
 		setUnselectedOutputs();
 
 		if (bIsLightsTurn) {
-			int currentLight
-				for (int step = 0; step < superSwitches::kMaxSteps; ++step) {
-					currentLight = LIGHT_STEP_1 + step * 2;
-					if (step < stepCount) {
-						lights[currentLight].setBrightness((step != selectedOut) *
-							kSanguineButtonLightValue);
-						lights[currentLight + 1].setBrightness((step == selectedOut) *
-							kSanguineButtonLightValue);
-					} else {
-						lights[currentLight].setBrightness(0.f);
-						lights[currentLight + 1].setBrightness(0.f);
-					}
+			updateStepButtons();
+
+			int currentLight;
+			for (int step = 0; step < superSwitches::kMaxSteps; ++step) {
+				currentLight = LIGHT_STEP_1 + step * 2;
+				if (step < stepCount) {
+					lights[currentLight].setBrightness((step != selectedOut) *
+						kSanguineButtonLightValue);
+					lights[currentLight + 1].setBrightness((step == selectedOut) *
+						kSanguineButtonLightValue);
+				} else {
+					lights[currentLight].setBrightness(0.f);
+					lights[currentLight + 1].setBrightness(0.f);
 				}
+			}
 
 			lights[LIGHT_RESET_TO_FIRST_STEP].setBrightness(
 				params[PARAM_RESET_TO_FIRST_STEP].getValue() * kSanguineButtonLightValue);
@@ -275,7 +300,7 @@ struct SuperSwitch18 : SanguineModule {
 	void handleParameterControls() {
 		bStepsMutex = false;
 		int knobValue = params[PARAM_STEPS].getValue();
-		if (bHaveStepsCable) {
+		if (bHaveStepsCable && !bAddressMode) {
 			int newStepCount = round(clamp(inputs[INPUT_STEPS].getVoltage(), 1.f, 8.f));
 			if (newStepCount != stepCount) {
 				stepCount = newStepCount;
@@ -287,9 +312,7 @@ struct SuperSwitch18 : SanguineModule {
 		}
 
 		if (selectedOut >= stepCount) {
-			params[selectedOut].setValue(0);
 			selectedOut = stepCount - 1;
-			params[selectedOut].setValue(1);
 		}
 
 		bNoRepeats = params[PARAM_NO_REPEATS].getValue();
@@ -306,40 +329,53 @@ struct SuperSwitch18 : SanguineModule {
 		bLastOneShotValue = bOneShot;
 	}
 
-	void checkReset() {
+	void checkReset(const int pressedButtons) {
 		if ((bHaveResetCable && stInputReset.process(inputs[INPUT_RESET].getVoltage())) ||
-			btReset.process(params[PARAM_RESET].getValue())) {
+			(pressedButtons & (1 << superSwitches::BUTTON_RESET))) {
 			doResetTrigger();
 		}
 	}
 
-	void handleClockControls() {
+	void handleClockControls(const int pressedButtons) {
 		if (!bOneShot || !bOneShotDone) {
 			if ((bHaveDecreaseCable && stInputDecrease.process(inputs[INPUT_DECREASE].getVoltage())) ||
-				btDecrease.process(params[PARAM_DECREASE].getValue())) {
+				(pressedButtons & (1 << superSwitches::BUTTON_DECREASE))) {
 				doDecreaseTrigger();
 			}
 
 			if ((bHaveIncreaseCable && stInputIncrease.process(inputs[INPUT_INCREASE].getVoltage())) ||
-				btIncrease.process(params[PARAM_INCREASE].getValue())) {
+				(pressedButtons & (1 << superSwitches::BUTTON_INCREASE))) {
 				doIncreaseTrigger();
 			}
 
 			if ((bHaveRandomCable && stInputRandom.process(inputs[INPUT_RANDOM].getVoltage())) ||
-				btRandom.process(params[PARAM_RANDOM].getValue())) {
+				(pressedButtons & (1 << superSwitches::BUTTON_RANDOM))) {
 				doRandomTrigger();
 			}
 		}
 	}
 
-	void handleStepButtons(const int stepNum) {
-		const int currentOut = PARAM_STEP1 + stepNum;
-		if (stepNum < stepCount && !bResetMutex && (!bOneShot || !bOneShotDone) &&
-			btSteps[stepNum].process(params[currentOut].getValue() && !bStepsMutex)) {
-			selectedOut = stepNum;
+	void handleStepButtons() {
+		int pressedSteps = stepButtons.scan(params, PARAM_STEP1);
+		if (pressedSteps && !bStepsMutex && !bResetMutex && (!bOneShot || !bOneShotDone)) {
+			for (int stepNum = 0; stepNum < stepCount; ++stepNum) {
+				if (pressedSteps & (1 << stepNum)) {
+					selectedOut = stepNum;
+				}
+			}
+		}
+	}
+
+	void updateStepButtons() {
+		for (int stepNum = 0; stepNum < superSwitches::kMaxSteps; ++stepNum) {
+			stepButtons.setButton(params, PARAM_STEP1, stepNum, stepNum == selectedOut ? 1.f : stepNum < stepCount ? 0.f : 2.f);
 		}
 	}
 
+	void handleStepAddress() {
+		selectedOut = superSwitches::getAddressedStep(inputs[INPUT_STEPS].getVoltage(), stepCount, selectedOut);
+	}
+
 	void copyVoltages() {
 		if (selectedOut >= 0 && bInputConnected && outputsConnected[selectedOut]) {
 			int currentChannel;
@@ -455,36 +491,33 @@ struct SuperSwitch18 : SanguineModule {
 	}
 
 #ifndef METAMODULE
-	void handleExpanderInput(const int stepNum) {
-		int currentIn = Manus::INPUT_STEP_1 + stepNum;
-		if (manusExpander->getInputConnected(stepNum) && stepNum < stepCount &&
+	void handleExpanderInput(const int stepNum, const manus::ControlsMessage* controlsMessage) {
+		if (controlsMessage->inputsConnected[stepNum] && stepNum < stepCount &&
 			(!bOneShot || !bOneShotDone) &&
-			stDirectSteps[stepNum].process(manusExpander->getInput(currentIn).getVoltage())) {
+			stDirectSteps[stepNum].process(controlsMessage->stepVoltages[stepNum >> 2][stepNum & 3])) {
 			selectedOut = stepNum;
 		}
 	}
 
-	void setExpanderLights(const float sampleTime) {
-		bool bLightActive;
-		int currentLight;
-		for (int step = 0; step < superSwitches::kMaxSteps; ++step) {
-			currentLight = Manus::LIGHT_STEP_1_LEFT + step;
-			bLightActive = step < stepCount;
-			manusExpander->getLight(currentLight).setBrightnessSmooth(
-				bLightActive * kSanguineButtonLightValue, sampleTime);
-		}
+	void sendManusStatus() {
+		manus::StatusMessage* statusMessage =
+			static_cast<manus::StatusMessage*>(rightExpander.module->leftExpander.producerMessage);
+
+		statusMessage->stepCount = stepCount;
+
+		rightExpander.module->leftExpander.requestMessageFlip();
 	}
 
 	void onBypass(const BypassEvent& e) override {
 		if (bHasExpander) {
-			manusExpander->getLight(Manus::LIGHT_MASTER_MODULE_LEFT).setBrightness(0.f);
+			rightExpander.module->getLight(Manus::LIGHT_MASTER_MODULE_LEFT).setBrightness(0.f);
 		}
 		Module::onBypass(e);
 	}
 
 	void onUnBypass(const UnBypassEvent& e) override {
 		if (bHasExpander) {
-			manusExpander->getLight(Manus::LIGHT_MASTER_MODULE_LEFT).setBrightness(kSanguineButtonLightValue);
+			rightExpander.module->getLight(Manus::LIGHT_MASTER_MODULE_LEFT).setBrightness(kSanguineButtonLightValue);
 		}
 		Module::onUnBypass(e);
 	}
@@ -494,10 +527,6 @@ struct SuperSwitch18 : SanguineModule {
 			Module* rightModule = getRightExpander().module;
 
 			bHasExpander = (rightModule && rightModule->getModel() == modelManus && !rightModule->isBypassed());
-
-			if (bHasExpander) {
-				manusExpander = dynamic_cast<Manus*>(rightModule);
-			}
 		}
 	}
 #endif
@@ -544,6 +573,7 @@ struct SuperSwitch18 : SanguineModule {
 		setJsonBoolean(rootJ, "noRepeats", bNoRepeats);
 		setJsonBoolean(rootJ, "ResetToFirstStep", bResetToFirstStep);
 		setJsonBoolean(rootJ, "oneShot", bOneShot);
+		setJsonBoolean(rootJ, "addressMode", bAddressMode);
 
 		return rootJ;
 	}
@@ -562,6 +592,8 @@ struct SuperSwitch18 : SanguineModule {
 			selectedOut = 0;
 		}
 
+		getJsonBoolean(rootJ, "addressMode", bAddressMode);
+
 		getJsonBoolean(rootJ, "oneShot", bOneShot);
 		params[PARAM_ONE_SHOT].setValue(bOneShot);
 
@@ -732,12 +764,18 @@ struct SuperSwitch18Widget : SanguineModuleWidget {
 #endif
 	}
 
-#ifndef METAMODULE
 	void appendContextMenu(Menu* menu) override {
 		SanguineModuleWidget::appendContextMenu(menu);
 
 		SuperSwitch18* superSwitch18 = dynamic_cast<SuperSwitch18*>(this->module);
 
+		menu->addChild(new MenuSeparator());
+
+		menu->addChild(createCheckMenuItem("Steps CV selects the step", "",
+			[=]() {return superSwitch18->bAddressMode; },
+			[=]() {superSwitch18->bAddressMode = !superSwitch18->bAddressMode; }));
+
+#ifndef METAMODULE
 		menu->addChild(new MenuSeparator());
 		const Module* expander = superSwitch18->rightExpander.module;
 		if (expander && expander->model == modelManus) {
@@ -747,8 +785,8 @@ struct SuperSwitch18Widget : SanguineModuleWidget {
 				superSwitch18->addExpander(modelManus, this);
 				}));
 		}
-	}
 #endif
+	}
 };
 
 Model* modelSuperSwitch18 = createModel<SuperSwitch18, SuperSwitch18Widget>("Sanguine-SuperSwitch18");
\ No newline at end of file
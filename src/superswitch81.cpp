@@ -11,7 +11,9 @@
 #include "pcg_random.hpp"
 #pragma GCC diagnostic pop
 
+#include "controlscanner.hpp"
 #include "switches.hpp"
+#include "triggerbank.hpp"
 #ifndef METAMODULE
 #include "manus.hpp"
 #endif
@@ -82,18 +84,16 @@ struct SuperSwitch81 : SanguineModule {
 		LIGHTS_COUNT
 	};
 
-	dsp::BooleanTrigger btDecrease;
-	dsp::BooleanTrigger btIncrease;
-	dsp::BooleanTrigger btRandom;
-	dsp::BooleanTrigger btReset;
-	dsp::BooleanTrigger btSteps[superSwitches::kMaxSteps];
+	// Buttons are scanned and step buttons written back on the lights turn.
+	controlScanners::ButtonScanner<superSwitches::TRANSPORT_BUTTONS_COUNT> transportButtons;
+	controlScanners::ButtonScanner<superSwitches::kMaxSteps> stepButtons;
 	dsp::SchmittTrigger stInputDecrease;
 	dsp::SchmittTrigger stInputIncrease;
 	dsp::SchmittTrigger stInputRandom;
 	dsp::SchmittTrigger stInputReset;
 #ifndef METAMODULE
 	dsp::SchmittTrigger stDirectSteps[superSwitches::kMaxSteps];
-	Manus* manusExpander = nullptr;
+	manus::ControlsMessage manusMessages[2];
 #endif
 
 	bool bLastOneShotValue = false;
@@ -105,6 +105,9 @@ struct SuperSwitch81 : SanguineModule {
 	bool bStepsMutex = false;
 	bool bResetMutex = false;
 
+	// The steps input selects the step every sample instead of setting the step count.
+	bool bAddressMode = false;
+
 	bool bHaveStepsCable = false;
 	bool bHaveResetCable = false;
 	bool bHaveDecreaseCable = false;
@@ -126,6 +129,20 @@ struct SuperSwitch81 : SanguineModule {
 
 	float_4 inVoltages[4] = {};
 
+	// Polyphonic selection: every output channel follows its own step, driven by its channel of the trigger inputs.
+	bool bPolyphonic = false;
+	int polyChannelCount = 1;
+	int polySelections[PORT_MAX_CHANNELS] = {};
+	int polyStepCounts[PORT_MAX_CHANNELS];
+	int polyStepsDone[PORT_MAX_CHANNELS] = {};
+	// Bit n set when channel n finished its one shot.
+	int polyOneShotsDone = 0;
+
+	triggerBanks::SchmittTriggerBank<> stPolyDecrease;
+	triggerBanks::SchmittTriggerBank<> stPolyIncrease;
+	triggerBanks::SchmittTriggerBank<> stPolyRandom;
+	triggerBanks::SchmittTriggerBank<> stPolyReset;
+
 	dsp::ClockDivider lightsDivider;
 
 	pcg32 pcgRng;
@@ -161,6 +178,15 @@ struct SuperSwitch81 : SanguineModule {
 		params[PARAM_RESET_TO_FIRST_STEP].setValue(1);
 		pcgRng = pcg32(static_cast<int>(std::round(system::getUnixTime())));
 
+#ifndef METAMODULE
+		leftExpander.producerMessage = &manusMessages[0];
+		leftExpander.consumerMessage = &manusMessages[1];
+#endif
+
+		for (int channel = 0; channel < PORT_MAX_CHANNELS; ++channel) {
+			polyStepCounts[channel] = superSwitches::kMaxSteps;
+		}
+
 		lightsDivider.setDivision(kLightsFrequency);
 	};
 
@@ -170,53 +196,58 @@ struct SuperSwitch81 : SanguineModule {
 
 		float sampleTime;
 
+		int pressedButtons = 0;
+
 		if (bIsLightsTurn) {
 			sampleTime = args.sampleTime * kLightsFrequency;
 
+			pressedButtons = transportButtons.scan(params, PARAM_DECREASE);
+
 			handleParameterControls();
 
 			lights[LIGHT_EXPANDER].setBrightnessSmooth(
 				bHasExpander * kSanguineButtonLightValue, sampleTime);
 		}
 
-		checkReset();
-
-		handleClockControls();
-
-		if (!bHasExpander) {
-			for (int stepNum = 0; stepNum < superSwitches::kMaxSteps; ++stepNum) {
-				handleStepButtons(stepNum);
+		if (!bPolyphonic) {
+			checkReset(pressedButtons);
 
-				params[stepNum].setValue(stepNum == selectedIn ? 1 : stepNum < stepCount ? 0 : 2);
-			}
+			handleClockControls(pressedButtons);
+		} else {
+			handlePolyphonicControls(pressedButtons);
+		}
 
-			inChannelCount = inputs[selectedIn].getChannels();
+		if (bAddressMode && bHaveStepsCable) {
+			handleStepAddress();
+		}
 
-			copyVoltages();
+		if (bIsLightsTurn) {
+			handleStepButtons();
+		}
 
-			setUnselectedInput();
+		if (!bHasExpander) {
+			routeVoltages();
 
 			bResetMutex = false;
 		} else {
-			for (int stepNum = 0; stepNum < superSwitches::kMaxSteps; ++stepNum) {
-				handleStepButtons(stepNum);
+			const manus::ControlsMessage* controlsMessage =
+				static_cast<manus::ControlsMessage*>(leftExpander.consumerMessage);
 
-				handleExpanderInput(stepNum);
-
-				params[stepNum].setValue(stepNum == selectedIn ? 1 : stepNum < stepCount ? 0 : 2);
+			for (int stepNum = 0; stepNum < superSwitches::kMaxSteps; ++stepNum) {
+				handleExpanderInput(stepNum, controlsMessage);
 			}
 
-			inChannelCount = inputs[selectedIn].getChannels();
-
-			copyVoltages();
-
-			setUnselectedInput();
+			routeVoltages();
 
 			if (bIsLightsTurn) {
-				setExpanderLights(sampleTime);
+				sendManusStatus();
 			}
 			bResetMutex = false;
 		}
+
+		if (bIsLightsTurn) {
+			updateStepButtons();
+		}
 	}
 #else
 	void process(const ProcessArgs& args) override {
@@ -224,27 +255,37 @@ struct SuperSwitch81 : SanguineModule {
 
 		float sampleTime;
 
+		int pressedButtons = 0;
+
 		if (bIsLightsTurn) {
 			sampleTime = args.sampleTime * kLightsFrequency;
 
+			pressedButtons = transportButtons.scan(params, PARAM_DECREASE);
+
 			handleParameterControls();
 		}
 
-		checkReset();
+		if (!bPolyphonic) {
+			checkReset(pressedButtons);
 
-		handleClockControls();
-
-		for (int stepNum = 0; stepNum < superSwitches::kMaxSteps; ++stepNum) {
-			handleStepButtons(stepNum);
+			handleClockControls(pressedButtons);
+		} else {
+			handlePolyphonicControls(pressedButtons);
+		}
 
-			params[stepNum].setValue(stepNum == selectedIn ? 1 : stepNum < stepCount ? 0 : 2);
+		if (bAddressMode && bHaveStepsCable) {
+			handleStepAddress();
 		}
 
-		inChannelCount = inputs[selectedIn].getChannels();
+		if (bIsLightsTurn) {
+			handleStepButtons();
+		}
 
-		copyVoltages();
+		routeVoltages();
 
-		setUnselectedInput();
+		if (bIsLightsTurn) {
+			updateStepButtons();
+		}
 
 		bResetMutex = false;
 	}
@@ -253,7 +294,7 @@ struct SuperSwitch81 : SanguineModule {
 	void handleParameterControls() {
 		bStepsMutex = false;
 		int knobValue = params[PARAM_STEPS].getValue();
-		if (bHaveStepsCable) {
+		if (bHaveStepsCable && !bAddressMode) {
 			int newStepCount = round(clamp(inputs[INPUT_STEPS].getVoltage(), 1.f, 8.f));
 			if (newStepCount != stepCount) {
 				stepCount = newStepCount;
@@ -265,56 +306,220 @@ struct SuperSwitch81 : SanguineModule {
 		}
 
 		if (selectedIn >= stepCount) {
-			params[PARAM_STEP1 + selectedIn].setValue(0);
 			selectedIn = stepCount - 1;
-			params[PARAM_STEP1 + selectedIn].setValue(1);
+		}
+
+		if (bPolyphonic) {
+			updatePolyphonicStepCounts();
 		}
 
 		bNoRepeats = params[PARAM_NO_REPEATS].getValue();
 		bResetToFirstStep = params[PARAM_RESET_TO_FIRST_STEP].getValue();
 		if (!bLastResetToFirstStepValue && bResetToFirstStep) {
-			selectedIn = 0;
+			selectStep(0);
 		}
 		bLastResetToFirstStepValue = bResetToFirstStep;
 		bOneShot = params[PARAM_ONE_SHOT].getValue();
 		if (bOneShot && (bOneShot != bLastOneShotValue)) {
 			bOneShotDone = false;
 			stepsDone = 0;
+
+			polyOneShotsDone = 0;
+			for (int channel = 0; channel < PORT_MAX_CHANNELS; ++channel) {
+				polyStepsDone[channel] = 0;
+			}
 		}
 		bLastOneShotValue = bOneShot;
 	}
 
-	void checkReset() {
+	void checkReset(const int pressedButtons) {
 		if ((bHaveResetCable && stInputReset.process(inputs[INPUT_RESET].getVoltage())) ||
-			btReset.process(params[PARAM_RESET].getValue())) {
+			(pressedButtons & (1 << superSwitches::BUTTON_RESET))) {
 			doResetTrigger();
 		}
 	}
 
-	void handleClockControls() {
+	void handleClockControls(const int pressedButtons) {
 		if (!bOneShot || !bOneShotDone) {
 			if ((bHaveDecreaseCable && stInputDecrease.process(inputs[INPUT_DECREASE].getVoltage())) ||
-				btDecrease.process(params[PARAM_DECREASE].getValue())) {
+				(pressedButtons & (1 << superSwitches::BUTTON_DECREASE))) {
 				doDecreaseTrigger();
 			}
 
 			if ((bHaveIncreaseCable && stInputIncrease.process(inputs[INPUT_INCREASE].getVoltage())) ||
-				btIncrease.process(params[PARAM_INCREASE].getValue())) {
+				(pressedButtons & (1 << superSwitches::BUTTON_INCREASE))) {
 				doIncreaseTrigger();
 			}
 
 			if ((bHaveRandomCable && stInputRandom.process(inputs[INPUT_RANDOM].getVoltage())) ||
-				btRandom.process(params[PARAM_RANDOM].getValue())) {
+				(pressedButtons & (1 << superSwitches::BUTTON_RANDOM))) {
 				doRandomTrigger();
 			}
 		}
 	}
 
-	void handleStepButtons(const int stepNum) {
-		const int currentIn = PARAM_STEP1 + stepNum;
-		if (stepNum < stepCount && !bResetMutex && (!bOneShot || !bOneShotDone) &&
-			btSteps[stepNum].process(params[currentIn].getValue() && !bStepsMutex)) {
-			selectedIn = stepNum;
+	void handleStepButtons() {
+		int pressedSteps = stepButtons.scan(params, PARAM_STEP1);
+		if (pressedSteps && !bStepsMutex && !bResetMutex && (!bOneShot || !bOneShotDone)) {
+			for (int stepNum = 0; stepNum < stepCount; ++stepNum) {
+				if (pressedSteps & (1 << stepNum)) {
+					selectStep(stepNum);
+				}
+			}
+		}
+	}
+
+	// Polyphonic selection shows the first channel.
+	void updateStepButtons() {
+		int shownStep = !bPolyphonic ? selectedIn : polySelections[0];
+		for (int stepNum = 0; stepNum < superSwitches::kMaxSteps; ++stepNum) {
+			stepButtons.setButton(params, PARAM_STEP1, stepNum, stepNum == shownStep ? 1.f : stepNum < stepCount ? 0.f : 2.f);
+		}
+	}
+
+	// Panel and expander step selections apply to every channel.
+	void selectStep(const int stepNum) {
+		selectedIn = stepNum;
+		for (int channel = 0; channel < PORT_MAX_CHANNELS; ++channel) {
+			polySelections[channel] = std::min(stepNum, polyStepCounts[channel] - 1);
+		}
+	}
+
+	void routeVoltages() {
+		if (!bPolyphonic) {
+			inChannelCount = inputs[selectedIn].getChannels();
+
+			copyVoltages();
+
+			setUnselectedInput();
+		} else {
+			copyPolyphonicVoltages();
+		}
+	}
+
+	void handlePolyphonicControls(const int pressedButtons) {
+		polyChannelCount = 1;
+		for (int input = 0; input < INPUTS_COUNT; ++input) {
+			polyChannelCount = std::max(polyChannelCount, inputs[input].getChannels());
+		}
+		const int channelsMask = (1 << polyChannelCount) - 1;
+
+		int resets = stPolyReset.processBroadcastInput(inputs[INPUT_RESET], channelsMask);
+		int decreases = stPolyDecrease.processBroadcastInput(inputs[INPUT_DECREASE], channelsMask);
+		int increases = stPolyIncrease.processBroadcastInput(inputs[INPUT_INCREASE], channelsMask);
+		int randoms = stPolyRandom.processBroadcastInput(inputs[INPUT_RANDOM], channelsMask);
+
+		// Panel buttons act on every channel.
+		if (pressedButtons & (1 << superSwitches::BUTTON_RESET)) {
+			resets = channelsMask;
+			bResetMutex = true;
+		}
+		if (pressedButtons & (1 << superSwitches::BUTTON_DECREASE)) {
+			decreases = channelsMask;
+		}
+		if (pressedButtons & (1 << superSwitches::BUTTON_INCREASE)) {
+			increases = channelsMask;
+		}
+		if (pressedButtons & (1 << superSwitches::BUTTON_RANDOM)) {
+			randoms = channelsMask;
+		}
+
+		int triggeredChannels = resets | decreases | increases | randoms;
+		while (triggeredChannels) {
+			const int channel = __builtin_ctz(triggeredChannels);
+			const int channelBit = 1 << channel;
+			triggeredChannels &= triggeredChannels - 1;
+
+			int& selection = polySelections[channel];
+			const int channelSteps = polyStepCounts[channel];
+
+			if (resets & channelBit) {
+				selection = bResetToFirstStep ? 0 : -1;
+				polyStepsDone[channel] = 0;
+				polyOneShotsDone &= ~channelBit;
+			}
+
+			if (bOneShot && (polyOneShotsDone & channelBit)) {
+				continue;
+			}
+
+			if (decreases & channelBit) {
+				--selection;
+				if (selection < 0) {
+					selection = channelSteps - 1;
+				}
+				countPolyphonicStep(channel);
+			}
+
+			if (increases & channelBit) {
+				++selection;
+				if (selection >= channelSteps) {
+					selection = 0;
+				}
+				countPolyphonicStep(channel);
+			}
+
+			if (randoms & channelBit) {
+				if (!bNoRepeats || selection < 0 || channelSteps < 2) {
+					selection = pcgRng(channelSteps);
+				} else {
+					// Draw from the other steps, skipping the current one.
+					int randomStep = pcgRng(channelSteps - 1);
+					selection = randomStep >= selection ? randomStep + 1 : randomStep;
+				}
+				countPolyphonicStep(channel);
+			}
+		}
+	}
+
+	void countPolyphonicStep(const int channel) {
+		++polyStepsDone[channel];
+		if (bOneShot && polyStepsDone[channel] == polyStepCounts[channel]) {
+			polyOneShotsDone |= 1 << channel;
+		}
+
+		if (polyStepsDone[channel] > polyStepCounts[channel]) {
+			polyStepsDone[channel] = 0;
+		}
+	}
+
+	void updatePolyphonicStepCounts() {
+		for (int channel = 0; channel < PORT_MAX_CHANNELS; ++channel) {
+			polyStepCounts[channel] = !bHaveStepsCable || bAddressMode ? stepCount :
+				static_cast<int>(std::round(clamp(inputs[INPUT_STEPS].getPolyVoltage(channel), 1.f, 8.f)));
+			if (polySelections[channel] >= polyStepCounts[channel]) {
+				polySelections[channel] = polyStepCounts[channel] - 1;
+			}
+		}
+	}
+
+	// Each channel picks its voltage from the input its step selects, four channels at a time.
+	void copyPolyphonicVoltages() {
+		if (bOutputConnected) {
+			for (int channel = 0; channel < polyChannelCount; channel += 4) {
+				float_4 selections = float_4(polySelections[channel], polySelections[channel + 1],
+					polySelections[channel + 2], polySelections[channel + 3]);
+				float_4 voltages = 0.f;
+				for (int step = 0; step < superSwitches::kMaxSteps; ++step) {
+					if (inputsConnected[step]) {
+						voltages = simd::ifelse(selections == static_cast<float>(step),
+							inputs[INPUT_IN1 + step].getPolyVoltageSimd<float_4>(channel), voltages);
+					}
+				}
+				outputs[OUTPUT_OUT].setVoltageSimd(voltages, channel);
+			}
+			outputs[OUTPUT_OUT].setChannels(polyChannelCount);
+		}
+	}
+
+	void handleStepAddress() {
+		if (!bPolyphonic) {
+			selectedIn = superSwitches::getAddressedStep(inputs[INPUT_STEPS].getVoltage(), stepCount, selectedIn);
+		} else {
+			for (int channel = 0; channel < polyChannelCount; ++channel) {
+				polySelections[channel] = superSwitches::getAddressedStep(inputs[INPUT_STEPS].getPolyVoltage(channel),
+					polyStepCounts[channel], polySelections[channel]);
+			}
 		}
 	}
 
@@ -409,6 +614,13 @@ struct SuperSwitch81 : SanguineModule {
 		}
 		stepCount = superSwitches::kMaxSteps;
 
+		polyOneShotsDone = 0;
+		for (int channel = 0; channel < PORT_MAX_CHANNELS; ++channel) {
+			polyStepCounts[channel] = superSwitches::kMaxSteps;
+			polyStepsDone[channel] = 0;
+		}
+		selectStep(selectedIn);
+
 		params[PARAM_STEPS].setValue(superSwitches::kMaxSteps);
 		params[PARAM_RESET_TO_FIRST_STEP].setValue(bResetToFirstStep);
 		bStepsMutex = false;
@@ -425,41 +637,38 @@ struct SuperSwitch81 : SanguineModule {
 
 	void onRandomize() override {
 		stepCount = pcgRng(superSwitches::kMaxSteps) + 1;
-		selectedIn = pcgRng(stepCount);
+		selectStep(pcgRng(stepCount));
 		params[PARAM_STEPS].setValue(stepCount);
 	}
 
 #ifndef METAMODULE
-	void handleExpanderInput(const int stepNum) {
-		int currentIn = Manus::INPUT_STEP_1 + stepNum;
-		if (manusExpander->getInputConnected(stepNum) && stepNum < stepCount &&
+	void handleExpanderInput(const int stepNum, const manus::ControlsMessage* controlsMessage) {
+		if (controlsMessage->inputsConnected[stepNum] && stepNum < stepCount &&
 			(!bOneShot || !bOneShotDone) &&
-			stDirectSteps[stepNum].process(manusExpander->getInput(currentIn).getVoltage())) {
-			selectedIn = stepNum;
+			stDirectSteps[stepNum].process(controlsMessage->stepVoltages[stepNum >> 2][stepNum & 3])) {
+			selectStep(stepNum);
 		}
 	}
 
-	void setExpanderLights(const float sampleTime) {
-		bool bLightActive;
-		int currentLight;
-		for (int step = 0; step < superSwitches::kMaxSteps; ++step) {
-			currentLight = Manus::LIGHT_STEP_1_RIGHT + step;
-			bLightActive = step < stepCount;
-			manusExpander->getLight(currentLight).setBrightnessSmooth(
-				bLightActive * kSanguineButtonLightValue, sampleTime);
-		}
+	void sendManusStatus() {
+		manus::StatusMessage* statusMessage =
+			static_cast<manus::StatusMessage*>(leftExpander.module->rightExpander.producerMessage);
+
+		statusMessage->stepCount = stepCount;
+
+		leftExpander.module->rightExpander.requestMessageFlip();
 	}
 
 	void onBypass(const BypassEvent& e) override {
 		if (bHasExpander) {
-			manusExpander->getLight(Manus::LIGHT_MASTER_MODULE_RIGHT).setBrightness(0.f);
+			leftExpander.module->getLight(Manus::LIGHT_MASTER_MODULE_RIGHT).setBrightness(0.f);
 		}
 		Module::onBypass(e);
 	}
 
 	void onUnBypass(const UnBypassEvent& e) override {
 		if (bHasExpander) {
-			manusExpander->getLight(Manus::LIGHT_MASTER_MODULE_RIGHT).setBrightness(kSanguineButtonLightValue);
+			leftExpander.module->getLight(Manus::LIGHT_MASTER_MODULE_RIGHT).setBrightness(kSanguineButtonLightValue);
 		}
 		Module::onUnBypass(e);
 	}
@@ -469,10 +678,6 @@ struct SuperSwitch81 : SanguineModule {
 			Module* leftModule = getLeftExpander().module;
 
 			bHasExpander = (leftModule && leftModule->getModel() == modelManus && !leftModule->isBypassed());
-
-			if (bHasExpander) {
-				manusExpander = dynamic_cast<Manus*>(leftModule);
-			}
 		}
 	}
 #endif
@@ -519,6 +724,8 @@ struct SuperSwitch81 : SanguineModule {
 		setJsonBoolean(rootJ, "noRepeats", bNoRepeats);
 		setJsonBoolean(rootJ, "resetToFirstStep", bResetToFirstStep);
 		setJsonBoolean(rootJ, "oneShot", bOneShot);
+		setJsonBoolean(rootJ, "addressMode", bAddressMode);
+		setJsonBoolean(rootJ, "polyphonicSelection", bPolyphonic);
 
 		return rootJ;
 	}
@@ -537,6 +744,8 @@ struct SuperSwitch81 : SanguineModule {
 			selectedIn = 0;
 		}
 
+		getJsonBoolean(rootJ, "addressMode", bAddressMode);
+
 		getJsonBoolean(rootJ, "oneShot", bOneShot);
 		params[PARAM_ONE_SHOT].setValue(bOneShot);
 
@@ -544,6 +753,10 @@ struct SuperSwitch81 : SanguineModule {
 			bOneShotDone = false;
 		}
 		bLastOneShotValue = bOneShot;
+
+		getJsonBoolean(rootJ, "polyphonicSelection", bPolyphonic);
+
+		selectStep(selectedIn);
 	}
 };
 
@@ -707,12 +920,22 @@ struct SuperSwitch81Widget : SanguineModuleWidget {
 #endif
 	}
 
-#ifndef METAMODULE
 	void appendContextMenu(Menu* menu) override {
 		SanguineModuleWidget::appendContextMenu(menu);
 
 		SuperSwitch81* superSwitch81 = dynamic_cast<SuperSwitch81*>(this->module);
 
+		menu->addChild(new MenuSeparator());
+
+		menu->addChild(createCheckMenuItem("Polyphonic step selection", "",
+			[=]() {return superSwitch81->bPolyphonic; },
+			[=]() {superSwitch81->bPolyphonic = !superSwitch81->bPolyphonic; }));
+
+		menu->addChild(createCheckMenuItem("Steps CV selects the step", "",
+			[=]() {return superSwitch81->bAddressMode; },
+			[=]() {superSwitch81->bAddressMode = !superSwitch81->bAddressMode; }));
+
+#ifndef METAMODULE
 		menu->addChild(new MenuSeparator());
 		const Module* expander = superSwitch81->leftExpander.module;
 		if (expander && expander->model == modelManus) {
@@ -722,8 +945,8 @@ struct SuperSwitch81Widget : SanguineModuleWidget {
 				superSwitch81->addExpander(modelManus, this, SanguineModule::EXPANDER_LEFT);
 				}));
 		}
-	}
 #endif
+	}
 };
 
 Model* modelSuperSwitch81 = createModel<SuperSwitch81, SuperSwitch81Widget>("Sanguine-SuperSwitch81");
\ No newline at end of file
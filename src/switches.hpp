@@ -4,4 +4,25 @@ using namespace sanguineCommonCode;
 
 namespace superSwitches {
     static const int kMaxSteps = 8;
+
+    // Transport buttons, in panel param order from PARAM_DECREASE.
+    enum TransportButtons {
+        BUTTON_DECREASE,
+        BUTTON_INCREASE,
+        BUTTON_RANDOM,
+        BUTTON_RESET,
+        TRANSPORT_BUTTONS_COUNT
+    };
+
+    // Address mode: 0 V to 10 V on the steps input spans the step count; a step holds until the voltage is this far into a neighbour.
+    static const float kAddressHysteresis = 0.1f;
+
+    inline int getAddressedStep(const float voltage, const int stepCount, const int currentStep) {
+        float position = clamp(voltage, 0.f, 10.f) * stepCount / 10.f;
+        if (currentStep >= 0 && currentStep < stepCount &&
+            position > currentStep - kAddressHysteresis && position < currentStep + 1 + kAddressHysteresis) {
+            return currentStep;
+        }
+        return std::min(static_cast<int>(position), stepCount - 1);
+    }
 }
\ No newline at end of file
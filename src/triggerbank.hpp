@@ -0,0 +1,60 @@
+#pragma once
+
+#include <rack.hpp>
+
+namespace triggerBanks {
+    /* Schmitt triggers for up to Lanes lanes, processed four lanes at a time.
+       A lane is either a channel of a polyphonic input or one of several mono inputs packed together.
+       Thresholds default to those of dsp::SchmittTrigger; modules set their own with setThresholds(). */
+    template <int Lanes = rack::PORT_MAX_CHANNELS>
+    struct SchmittTriggerBank {
+        rack::dsp::TSchmittTrigger<rack::simd::float_4> triggers[(Lanes + 3) / 4];
+
+        float lowThreshold = 0.f;
+        float highThreshold = 1.f;
+
+        void setThresholds(const float newLowThreshold, const float newHighThreshold) {
+            lowThreshold = newLowThreshold;
+            highThreshold = newHighThreshold;
+        }
+
+        void reset() {
+            for (rack::dsp::TSchmittTrigger<rack::simd::float_4>& trigger : triggers) {
+                trigger.reset();
+            }
+        }
+
+        // Returns a lane mask, all bits set for lanes that went high.
+        rack::simd::float_4 process(const int lane, const rack::simd::float_4 voltages) {
+            return triggers[lane >> 2].process(voltages, lowThreshold, highThreshold);
+        }
+
+        // Returns a bitmask with bit n set when lane n went high.
+        int processBits(const int lane, const rack::simd::float_4 voltages) {
+            return rack::simd::movemask(process(lane, voltages)) << lane;
+        }
+
+        // Processes the first channelCount channels of an input; bit n of the result is set when channel n went high.
+        int processInput(rack::engine::Input& input, const int channelCount) {
+            int triggeredChannels = 0;
+            for (int channel = 0; channel < channelCount; channel += 4) {
+                triggeredChannels |= processBits(channel, input.getVoltageSimd<rack::simd::float_4>(channel));
+            }
+            return triggeredChannels;
+        }
+
+        // Like processInput, but a mono input drives every channel in channelsMask.
+        int processBroadcastInput(rack::engine::Input& input, const int channelsMask) {
+            int inputChannels = input.getChannels();
+            int triggeredChannels = processInput(input, inputChannels) & ((1 << inputChannels) - 1);
+            if (inputChannels == 1 && triggeredChannels) {
+                return channelsMask;
+            }
+            return triggeredChannels & channelsMask;
+        }
+
+        rack::simd::float_4 isHigh(const int lane) {
+            return triggers[lane >> 2].isHigh();
+        }
+    };
+}
@@ -2,6 +2,8 @@
 #include "sanguinecomponents.hpp"
 #include "sanguinehelpers.hpp"
 
+#include "kerneltable.hpp"
+
 using namespace sanguineCommonCode;
 
 struct Werewolf : SanguineModule {
@@ -34,12 +36,27 @@ struct Werewolf : SanguineModule {
 		LIGHTS_COUNT
 	};
 
+	enum ConnectionBits {
+		CONNECTION_LEFT_IN = 1 << 0,
+		CONNECTION_RIGHT_IN = 1 << 1,
+		CONNECTION_LEFT_OUT = 1 << 2,
+		CONNECTION_RIGHT_OUT = 1 << 3,
+		CONNECTIONS_COUNT = 1 << 4
+	};
+
+	typedef void (Werewolf::* ProcessKernel)(const ProcessArgs& args);
+
+	// Every combination of connected stereo ports gets its own, branch free, process kernel.
+	template <int ConnectionMask>
+	struct ConnectedKernel {
+		static ProcessKernel kernel() { return &Werewolf::processConnected<ConnectionMask>; }
+	};
+
 	dsp::ClockDivider lightsDivider;
 
-	bool bLeftInConnected = false;
-	bool bRightInConnected = false;
-	bool bLeftOutConnected = false;
-	bool bRightOutConnected = false;
+	int connectionMask = 0;
+
+	ProcessKernel processKernel = &Werewolf::processConnected<0>;
 
 	const int kLightsFrequency = 64;
 
@@ -62,6 +79,16 @@ struct Werewolf : SanguineModule {
 	}
 
 	void process(const ProcessArgs& args) override {
+		(this->*processKernel)(args);
+	}
+
+	template <int ConnectionMask>
+	void processConnected(const ProcessArgs& args) {
+		const bool bLeftInConnected = ConnectionMask & CONNECTION_LEFT_IN;
+		const bool bRightInConnected = ConnectionMask & CONNECTION_RIGHT_IN;
+		const bool bLeftOutConnected = ConnectionMask & CONNECTION_LEFT_OUT;
+		const bool bRightOutConnected = ConnectionMask & CONNECTION_RIGHT_OUT;
+
 		float voltageSumLeft = 0.f;
 		float voltageSumRight = 0.f;
 		float foldSum = 0.f;
@@ -274,16 +301,27 @@ struct Werewolf : SanguineModule {
 		}
 	}
 
+	void setConnection(const int connection, const bool connected) {
+		if (connected) {
+			connectionMask |= connection;
+		} else {
+			connectionMask &= ~connection;
+		}
+
+		static const kernelTables::KernelTable<ProcessKernel, CONNECTIONS_COUNT, ConnectedKernel> kernelTable;
+		processKernel = kernelTable.kernels[connectionMask];
+	}
+
 	void onPortChange(const PortChangeEvent& e) override {
 		switch (e.type) {
 		case Port::INPUT:
 			switch (e.portId) {
 			case INPUT_LEFT:
-				bLeftInConnected = e.connecting;
+				setConnection(CONNECTION_LEFT_IN, e.connecting);
 				break;
 
 			case INPUT_RIGHT:
-				bRightInConnected = e.connecting;
+				setConnection(CONNECTION_RIGHT_IN, e.connecting);
 				break;
 
 			default:
@@ -294,11 +332,11 @@ struct Werewolf : SanguineModule {
 		case Port::OUTPUT:
 			switch (e.portId) {
 			case OUTPUT_LEFT:
-				bLeftOutConnected = e.connecting;
+				setConnection(CONNECTION_LEFT_OUT, e.connecting);
 				break;
 
 			case OUTPUT_RIGHT:
-				bRightOutConnected = e.connecting;
+				setConnection(CONNECTION_RIGHT_OUT, e.connecting);
 				break;
 			}
 			break;
@@ -0,0 +1,284 @@
+#include <cstdio>
+#include <random>
+
+#include "mutesolo.hpp"
+
+/* Checks muteSolo::MuteSoloEngine against Alchemist's original channel by channel mute and solo logic over random
+   button presses, Crucible controls and Crucible CV. */
+
+static const int kChannels = muteSolo::kChannels;
+
+// Alchemist's mute and solo handling before it moved to bitmasks, kept as the reference.
+struct ReferenceMuteSolo {
+    bool mutedChannels[kChannels] = {};
+    bool soloedChannels[kChannels] = {};
+    int soloCount = 0;
+
+    int exclusiveMuteChannel = -1;
+    int exclusiveSoloChannel = -1;
+
+    bool bLastAllMuted = false;
+    bool bLastAllSoloed = false;
+
+    bool bMuteAllEnabled = false;
+    bool bSoloAllEnabled = false;
+
+    bool bMuteExclusiveEnabled = false;
+    bool bSoloExclusiveEnabled = false;
+
+    bool bHaveExpanderMuteCv = false;
+    bool bHaveExpanderSoloCv = false;
+
+    bool bLastHaveExpanderMuteCv = false;
+    bool bLastHaveExpanderSoloCv = false;
+
+    bool bClearCrucibleMuteAll = false;
+    bool bClearCrucibleSoloAll = false;
+
+    void resolve(const int pressedMutes, const int pressedSolos) {
+        soloCount = 0;
+
+        for (int channel = 0; channel < kChannels; ++channel) {
+            if ((pressedMutes >> channel) & 1) {
+                mutedChannels[channel] = !mutedChannels[channel];
+                soloedChannels[channel] = false;
+            }
+
+            if ((pressedSolos >> channel) & 1) {
+                soloedChannels[channel] = !soloedChannels[channel];
+                mutedChannels[channel] = false;
+            }
+
+            if (soloedChannels[channel]) {
+                ++soloCount;
+                mutedChannels[channel] = false;
+            }
+        }
+    }
+
+    void resolveCrucible(const int pressedMutes, const int pressedSolos, const int cvMutes, const int cvSolos,
+        const int channelCount) {
+        bool bIgnoreMuteAll = false;
+        bool bIgnoreSoloAll = false;
+
+        soloCount = 0;
+
+        for (int channel = 0; channel < kChannels; ++channel) {
+            if ((pressedMutes >> channel) & 1) {
+                mutedChannels[channel] = !mutedChannels[channel];
+                soloedChannels[channel] = false;
+
+                if ((bMuteAllEnabled && bLastAllMuted) && !mutedChannels[channel]) {
+                    bMuteAllEnabled = false;
+                    bClearCrucibleMuteAll = true;
+                    bIgnoreMuteAll = true;
+                }
+
+                if (bSoloAllEnabled && bLastAllSoloed) {
+                    bSoloAllEnabled = false;
+                    bClearCrucibleSoloAll = true;
+                    bIgnoreSoloAll = true;
+                }
+
+                exclusiveMuteChannel = exclusiveMuteChannel != channel ? channel : -1;
+            }
+
+            if (bHaveExpanderMuteCv && channel < channelCount) {
+                mutedChannels[channel] = (cvMutes >> channel) & 1;
+                exclusiveMuteChannel = -1;
+            }
+
+            if ((pressedSolos >> channel) & 1) {
+                soloedChannels[channel] = !soloedChannels[channel];
+                mutedChannels[channel] = false;
+
+                if (bMuteAllEnabled && bLastAllMuted) {
+                    bMuteAllEnabled = false;
+                    bClearCrucibleMuteAll = true;
+                    bIgnoreMuteAll = true;
+                }
+
+                if ((bSoloAllEnabled && bLastAllSoloed) && !soloedChannels[channel]) {
+                    bSoloAllEnabled = false;
+                    bClearCrucibleSoloAll = true;
+                    bIgnoreSoloAll = true;
+                }
+
+                exclusiveSoloChannel = exclusiveSoloChannel != channel ? channel : -1;
+            }
+
+            if (bHaveExpanderSoloCv && channel < channelCount) {
+                soloedChannels[channel] = (cvSolos >> channel) & 1;
+                exclusiveSoloChannel = -1;
+            }
+
+            if (!bMuteExclusiveEnabled && !bIgnoreMuteAll && ((bLastAllMuted != bMuteAllEnabled) |
+                (bLastHaveExpanderMuteCv != bHaveExpanderMuteCv))) {
+                mutedChannels[channel] = bMuteAllEnabled;
+            }
+
+            if (!bSoloExclusiveEnabled && !bIgnoreSoloAll && ((bLastAllSoloed != bSoloAllEnabled) |
+                (bLastHaveExpanderSoloCv != bHaveExpanderSoloCv))) {
+                soloedChannels[channel] = bSoloAllEnabled;
+            }
+
+            if (bMuteExclusiveEnabled && channel != exclusiveMuteChannel && exclusiveMuteChannel >= 0) {
+                mutedChannels[channel] = false;
+            }
+
+            if (bSoloExclusiveEnabled && channel != exclusiveSoloChannel && exclusiveSoloChannel >= 0) {
+                soloedChannels[channel] = false;
+            }
+
+            if (soloedChannels[channel]) {
+                ++soloCount;
+                mutedChannels[channel] = false;
+            }
+        }
+
+        setCrucibleValues();
+    }
+
+    void setCrucibleValues() {
+        if (bLastAllMuted != bMuteAllEnabled) {
+            bLastAllMuted = bMuteAllEnabled;
+
+            if (bMuteAllEnabled) {
+                for (int channel = 0; channel < kChannels; ++channel) {
+                    mutedChannels[channel] = true;
+                    soloedChannels[channel] = false;
+                }
+            }
+
+            if (bSoloAllEnabled) {
+                bSoloAllEnabled = false;
+                bLastAllSoloed = false;
+                bClearCrucibleSoloAll = true;
+            }
+        }
+
+        if (bLastAllSoloed != bSoloAllEnabled) {
+            bLastAllSoloed = bSoloAllEnabled;
+
+            if (bSoloAllEnabled) {
+                for (int channel = 0; channel < kChannels; ++channel) {
+                    soloedChannels[channel] = true;
+                    mutedChannels[channel] = false;
+                }
+            }
+
+            if (bMuteAllEnabled) {
+                bMuteAllEnabled = false;
+                bLastAllMuted = false;
+                bClearCrucibleMuteAll = true;
+            }
+        }
+    }
+
+    void setPreviousExpanderVoltages() {
+        bLastHaveExpanderMuteCv = bHaveExpanderMuteCv;
+        bLastHaveExpanderSoloCv = bHaveExpanderSoloCv;
+    }
+
+    static int getBits(const bool* channels) {
+        int bits = 0;
+        for (int channel = 0; channel < kChannels; ++channel) {
+            bits |= channels[channel] << channel;
+        }
+        return bits;
+    }
+};
+
+static bool matches(const muteSolo::MuteSoloEngine& engine, const ReferenceMuteSolo& reference) {
+    return engine.mutedChannels == ReferenceMuteSolo::getBits(reference.mutedChannels) &&
+        engine.soloedChannels == ReferenceMuteSolo::getBits(reference.soloedChannels) &&
+        engine.soloCount == reference.soloCount &&
+        engine.exclusiveMuteChannel == reference.exclusiveMuteChannel &&
+        engine.exclusiveSoloChannel == reference.exclusiveSoloChannel &&
+        engine.bLastAllMuted == reference.bLastAllMuted &&
+        engine.bLastAllSoloed == reference.bLastAllSoloed &&
+        engine.bMuteAllEnabled == reference.bMuteAllEnabled &&
+        engine.bSoloAllEnabled == reference.bSoloAllEnabled &&
+        engine.bClearCrucibleMuteAll == reference.bClearCrucibleMuteAll &&
+        engine.bClearCrucibleSoloAll == reference.bClearCrucibleSoloAll;
+}
+
+// Mostly no presses, sometimes one, now and then several on the same turn.
+static int getPresses(std::mt19937& rng) {
+    const unsigned roll = rng() % 16;
+    if (roll < 10) {
+        return 0;
+    }
+    if (roll < 14) {
+        return 1 << (rng() % kChannels);
+    }
+    return rng() & muteSolo::kAllChannels;
+}
+
+int main() {
+    static const int kRuns = 2000;
+    static const int kTurns = 500;
+
+    std::mt19937 rng(1);
+    int failures = 0;
+
+    for (int run = 0; run < kRuns && failures == 0; ++run) {
+        muteSolo::MuteSoloEngine engine;
+        ReferenceMuteSolo reference;
+
+        const bool bHaveCrucible = run % 4 != 0;
+
+        for (int turn = 0; turn < kTurns; ++turn) {
+            const int pressedMutes = getPresses(rng);
+            const int pressedSolos = getPresses(rng);
+
+            if (!bHaveCrucible) {
+                engine.resolve(pressedMutes, pressedSolos);
+                reference.resolve(pressedMutes, pressedSolos);
+            } else {
+                // Crucible controls change rarely, as they would from its panel.
+                if (rng() % 8 == 0) {
+                    const bool bMuteExclusive = rng() % 4 == 0;
+                    const bool bSoloExclusive = rng() % 4 == 0;
+                    const bool bMuteAll = !bMuteExclusive && rng() % 3 == 0;
+                    const bool bSoloAll = !bSoloExclusive && rng() % 3 == 0;
+                    engine.bMuteExclusiveEnabled = reference.bMuteExclusiveEnabled = bMuteExclusive;
+                    engine.bSoloExclusiveEnabled = reference.bSoloExclusiveEnabled = bSoloExclusive;
+                    engine.bMuteAllEnabled = reference.bMuteAllEnabled = bMuteAll;
+                    engine.bSoloAllEnabled = reference.bSoloAllEnabled = bSoloAll;
+                }
+                if (rng() % 16 == 0) {
+                    const bool bMuteCv = rng() % 3 == 0;
+                    const bool bSoloCv = rng() % 3 == 0;
+                    engine.bHaveExpanderMuteCv = reference.bHaveExpanderMuteCv = bMuteCv;
+                    engine.bHaveExpanderSoloCv = reference.bHaveExpanderSoloCv = bSoloCv;
+                }
+
+                const int cvMutes = rng() & muteSolo::kAllChannels;
+                const int cvSolos = rng() & muteSolo::kAllChannels;
+                const int channelCount = rng() % (kChannels + 1);
+
+                engine.resolveCrucible(pressedMutes, pressedSolos, cvMutes, cvSolos, channelCount);
+                engine.setPreviousExpanderVoltages();
+                reference.resolveCrucible(pressedMutes, pressedSolos, cvMutes, cvSolos, channelCount);
+                reference.setPreviousExpanderVoltages();
+            }
+
+            if (!matches(engine, reference)) {
+                std::printf("run %d, turn %d: muted %04x/%04x, soloed %04x/%04x, solo count %d/%d\n", run, turn,
+                    engine.mutedChannels, ReferenceMuteSolo::getBits(reference.mutedChannels),
+                    engine.soloedChannels, ReferenceMuteSolo::getBits(reference.soloedChannels),
+                    engine.soloCount, reference.soloCount);
+                ++failures;
+                break;
+            }
+
+            // Alchemist clears these once it has told Crucible.
+            engine.bClearCrucibleMuteAll = reference.bClearCrucibleMuteAll = false;
+            engine.bClearCrucibleSoloAll = reference.bClearCrucibleSoloAll = false;
+        }
+    }
+
+    std::printf("mutesolo: %s\n", failures == 0 ? "passed" : "FAILED");
+    return failures == 0 ? 0 : 1;
+}
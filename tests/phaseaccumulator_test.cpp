@@ -0,0 +1,81 @@
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include <simd/functions.hpp>
+
+using namespace rack;
+
+#include "chronos.hpp"
+
+/* Runs chronos::PhaseAccumulator4 for hours of 48 kHz samples, with its lanes a quarter cycle apart, and checks it
+   against exact integer arithmetic: the lanes must keep their offsets and every sample must advance by the whole
+   number of steps nearest to the increment. */
+
+static const int64_t kSampleRate = 48000;
+static const int64_t kHours = 3;
+static const int64_t kSamples = kSampleRate * 3600 * kHours;
+static const int64_t kCheckInterval = kSampleRate * 60;
+
+static const float kStartPhases[4] = { 0.f, 0.25f, 0.5f, 0.75f };
+
+static bool testIncrement(const char* name, const float increment) {
+    chronos::PhaseAccumulator4 accumulator;
+    accumulator.setPhases(float_4::load(kStartPhases));
+
+    uint32_t startPhases[4];
+    for (int lane = 0; lane < 4; ++lane) {
+        startPhases[lane] = static_cast<uint32_t>(accumulator.phases[lane]);
+    }
+
+    // The product is exact in float: the nearest step is the nearest integer to it.
+    const uint64_t step = static_cast<uint64_t>(std::nearbyint(static_cast<double>(increment) * 4294967296.0));
+
+    for (int64_t sample = 1; sample <= kSamples; ++sample) {
+        accumulator.advance(float_4(increment));
+
+        if (sample % kCheckInterval != 0) {
+            continue;
+        }
+
+        for (int lane = 0; lane < 4; ++lane) {
+            const uint32_t expectedPhase = static_cast<uint32_t>(startPhases[lane] + step * sample);
+            const uint32_t phase = static_cast<uint32_t>(accumulator.phases[lane]);
+            const uint32_t offset = phase - static_cast<uint32_t>(accumulator.phases[0]);
+
+            if (phase != expectedPhase || offset != static_cast<uint32_t>(lane) << 30) {
+                std::printf("%s: lane %d after %lld samples: phase %08x, expected %08x, offset %08x\n", name, lane,
+                    static_cast<long long>(sample), phase, expectedPhase, offset);
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+int main() {
+    static const struct {
+        const char* name;
+        float increment;
+    } kIncrements[] = {
+        { "0.01 Hz", 0.01f / kSampleRate },
+        { "1 Hz", 1.f / kSampleRate },
+        { "440 Hz", 440.f / kSampleRate },
+        // Three quarters of a step over a whole number: truncating would lose them every sample.
+        { "16384.75 steps", 16384.75f / 4294967296.f }
+    };
+
+    int failures = 0;
+
+    for (const auto& increment : kIncrements) {
+        if (!testIncrement(increment.name, increment.increment)) {
+            ++failures;
+        }
+    }
+
+    std::printf("phaseaccumulator: %s\n", failures == 0 ? "passed" : "FAILED");
+    return failures == 0 ? 0 : 1;
+}